@@ -6,17 +6,36 @@
 #include "CGameManager.h"
 #include "CSettingsManager.h"
 #include <gbx.h>
+#include <dmp.h>
+#include <mdb.h>
+#include <imx.h>
 #include <usb.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
-
-#define FILE_SCAN_BUFFER_SIZE 512
-#define FILE_SCAN_BUFFER_READ(buff0, buff1, index)   ((index) >= FILE_SCAN_BUFFER_SIZE*2 ? 0 : ((index) < FILE_SCAN_BUFFER_SIZE ? buff0[(index)] : buff1[(index)-FILE_SCAN_BUFFER_SIZE]))
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define MAX_FILENAME_SIZE 256
 #define MAX_ROMS 1024
+#define VERIFY_BLOCK_SIZE 4096
+#define SAVE_COMPARE_BLOCK_SIZE 1024
+#define MAX_STAGING_FILES 4
+#define CATALOG_CACHE_SOURCES 9
+#define CATALOG_CACHE_ROM_SOURCES 3
+#define CATALOG_CACHE_INVALID -1
+#define CATALOG_CACHE_ROMS_CHANGED 0
+#define CATALOG_CACHE_VALID 1
+
+typedef struct {
+	const char* expected;
+	unsigned int blockSize;
+	bool mismatch;
+} gm_compareState;
 
 //data constants
 static const char* gm_romLocation = "/home/pi/RetroPie/roms";
@@ -37,6 +56,8 @@ static const char* gm_snapImgPathGBA = "/home/pi/libretro/gba/Named_Snaps/";
 static const char* gm_titleImgPathGB = "/home/pi/libretro/gb/Named_Titles/";
 static const char* gm_titleImgPathGBC = "/home/pi/libretro/gbc/Named_Titles/";
 static const char* gm_titleImgPathGBA = "/home/pi/libretro/gba/Named_Titles/";
+static const char* const gm_imageFolders[] = { gm_boxartImgPathGB, gm_boxartImgPathGBC, gm_boxartImgPathGBA, gm_snapImgPathGB, gm_snapImgPathGBC, gm_snapImgPathGBA, gm_titleImgPathGB, gm_titleImgPathGBC, gm_titleImgPathGBA, 0 };
+static const char* const gm_imageIndexes[] = { "data/gb_Named_Boxarts.idx", "data/gbc_Named_Boxarts.idx", "data/gba_Named_Boxarts.idx", "data/gb_Named_Snaps.idx", "data/gbc_Named_Snaps.idx", "data/gba_Named_Snaps.idx", "data/gb_Named_Titles.idx", "data/gbc_Named_Titles.idx", "data/gba_Named_Titles.idx", 0 };
 
 static const char* gm_boxartImgDefaultGB = "data/img/box_gb.png";
 static const char* gm_boxartImgDefaultGBC = "data/img/box_gbc.png";
@@ -61,6 +82,13 @@ static const char* gm_stateExAll = ".state";
 static const char* gm_listGB = "data/GameBoy.json";
 static const char* gm_listGBC = "data/GameBoyColor.json";
 static const char* gm_listGBA = "data/GameBoyAdvance.json";
+static const char* gm_listIndexGB = "data/GameBoy.idx";
+static const char* gm_listIndexGBC = "data/GameBoyColor.idx";
+static const char* gm_listIndexGBA = "data/GameBoyAdvance.idx";
+
+static const char* gm_catalogCacheFile = "data/catalog.cache";
+static const char* gm_catalogCacheMagic = "GBXCATALOG1";
+static const char* const gm_catalogCacheSources[] = { gm_romPathGB, gm_romPathGBC, gm_romPathGBA, gm_boxartImgPathGB, gm_boxartImgPathGBC, gm_boxartImgPathGBA, gm_listGB, gm_listGBC, gm_listGBA };
 
 static const char* gm_emulatorsPath = "/opt/retropie/libretrocores/";
 static const char* gm_emulatorRetroarch = "/opt/retropie/emulators/retroarch/bin/retroarch";
@@ -76,6 +104,18 @@ static const char* const gm_emulatorSaveExGBA[] = { ".sav", ".srm", 0 };
 static const char* gm_emulatorSettingGB = "game.gb.emulator";
 static const char* gm_emulatorSettingGBA = "game.gba.emulator";
 
+static const char* gm_stagePrefetchSetting = "sync.prefetch";
+static const char* gm_stagingPath = "data/staging/";
+
+static const char* gm_verifySamplesSetting = "sync.verify.samples";
+static const char* gm_archiveSetting = "sync.archive";
+static const char* gm_archivePath = "data/dumps/";
+static const char* gm_archiveEx = ".gbd";
+
+static const char* gm_fileReadRateSetting = "sync.file.read.rate";
+static const char* gm_fileWriteRateSetting = "sync.file.write.rate";
+static const char* gm_timingModelFile = "data/timing.txt";
+
 static const char* gm_biosGBA = "gba_bios.bin";
 static const char* gm_biosPathGBA = "/home/pi/RetroPie/BIOS/";
 
@@ -86,22 +126,28 @@ static const char* gm_usbBackupPathGBA = "GBConsole_backup/gba/";
 
 //helper functions
 static int gm_addRomsInDir(const char* dirPath, const char* fileExt, char** filenames, int count);
-static bool gm_searchFileForDetails(const char* filePath, const char* identifier, char* dName, char* dDetails);
-static bool gm_searchFileForDetails(const char* filePath, const char* fileExt, char** catalogFilenames, char** catalogNames, int catalogSize);
-static char* gm_searchForImage(const char* dirPath, const char* name, const char* filename, const char* defaultImg);
+static bool gm_searchIndexForDetails(void* index, const char* identifier, char* dName, char* dDetails);
+static bool gm_searchIndexForNames(void* index, const char* fileExt, char** catalogFilenames, char** catalogNames, int catalogSize);
+static char* gm_searchForImage(void* index, const char* dirPath, const char* name, const char* filename, const char* defaultImg);
+static int gm_readCatalogCache(char** filenames, char** names, char** boxarts, unsigned int* sizes, int* count);
+static void gm_catalogStamps(long* stamps);
+static unsigned int gm_catalogFileSize(const char* filename);
 static char* gm_strClone(const char* str);
-static void gm_strSimplify(char* buffer, const char* str);
 static void gm_strReplace(char* str, char find, char to);
 static void gm_strRemove(char* str, char find);
 static void gm_strFileSanitize(char* str);
-static void gm_strToUpper(char* str);
-static bool gm_strStartsWith(const char* str, const char* find);
-static int gm_strLevenshtein(const char* s, const char* t);
+static int gm_strLevenshtein(const char* s, const char* t, int maxDistance);
 static bool gm_fileExists(const char* filename);
 static bool gm_directoryExists(const char* dirname);
 static void gm_ensureDirectory(const char* dirname);
 static void gm_renameFile(const char* from, const char* to);
 static int gm_compareCatalogElements(const void* elem1, const void* elem2);
+static int gm_waitForJob(gbx_job* job, float* progress, float progressStart, float progressScale, bool* cancel);
+static int gm_compareBlock(char* block, unsigned int blockIndex, unsigned int length, void* param);
+static void gm_saveBlockOrder(unsigned int* order, unsigned int count);
+static long gm_millis();
+static unsigned int gm_stagedLength(const char* filename, unsigned int romSize);
+static void gm_evictStaging(const char* keepFilename);
 
 //! Main constructor
 CGameManager::CGameManager(CSettingsManager* settingsManager)
@@ -119,6 +165,16 @@ CGameManager::CGameManager(CSettingsManager* settingsManager)
 	catalogFilenames = 0;
 	catalogImgBoxarts = 0;
 	
+	verifySamples = 0;
+	verifyConfidence = -1.0f;
+	archive = false;
+	stagePrefetch = false;
+	stageStopped = false;
+	stageJob = 0;
+	stageData = 0;
+	stageFingerprint = 0;
+	stageWritten = 0;
+	
 	//make sure backup directories are created
 	gm_ensureDirectory(gm_saveBackupPathGB);
 	gm_ensureDirectory(gm_saveBackupPathGBC);
@@ -135,9 +191,23 @@ CGameManager::CGameManager(CSettingsManager* settingsManager)
 	stmgr = settingsManager;
 	initSettings();
 	
+	//load measured cartridge transfer rates
+	gbx_loadTimingModel(gm_timingModelFile);
+	
 	//update BIOS
 	updateBIOS();
 	
+	//map the game lists (rebuilt from json if it changed)
+	listIndexGB = mdb_open(gm_listGB, gm_listIndexGB);
+	listIndexGBC = mdb_open(gm_listGBC, gm_listIndexGBC);
+	listIndexGBA = mdb_open(gm_listGBA, gm_listIndexGBA);
+	
+	//image folder indexes are opened on first use
+	int numImageFolders = 0;
+	while(gm_imageFolders[numImageFolders] != 0) numImageFolders++;
+	imageIndexes = new void*[numImageFolders];
+	for(int i=0; i<numImageFolders; i++) imageIndexes[i] = 0;
+	
 	//init catalog
 	loadCatalog();
 }
@@ -145,6 +215,16 @@ CGameManager::CGameManager(CSettingsManager* settingsManager)
 //! Destructor
 CGameManager::~CGameManager()
 {
+	//stop any background dump
+	stopStaging();
+	
+	//unmap game lists
+	mdb_close(listIndexGB);
+	mdb_close(listIndexGBC);
+	mdb_close(listIndexGBA);
+	for(int i=0; gm_imageFolders[i] != 0; i++) imx_close(imageIndexes[i]);
+	delete[] imageIndexes;
+	
 	//free resources
 	for(int i=0; i<numEmulatorsGB; i++) delete[] availableEmulatorsGB[i];
 	delete[] availableEmulatorsGB;
@@ -183,6 +263,11 @@ CGameManager::~CGameManager()
 //! Loads info of connected cartridge
 void CGameManager::loadCartridge()
 {
+	//stop dumping the previous cartridge (keeps what was dumped so far)
+	stopStaging();
+	stageStopped = false;
+	stageFingerprint = 0;
+	
 	//clear old data
 	delete[] cartName;
 	delete[] cartFilename;
@@ -197,8 +282,8 @@ void CGameManager::loadCartridge()
 	cartCatalogIndex = -1;
 	cartType = CARTRIDGE_TYPE_NONE;
 	
-	//check current cartridge
-	if(gbx_loadHeader() > 0) {
+	//check current cartridge (the monitor may have already loaded the header)
+	if(gbx_isLoaded() > 0 || gbx_loadHeader() > 0) {
 		//cart type
 		if(gbx_getCartridgeType()==GBX_CARTRIDGE_TYPE_GB) cartType = CARTRIDGE_TYPE_GB;
 		else if(gbx_getCartridgeType()==GBX_CARTRIDGE_TYPE_GBC) cartType = CARTRIDGE_TYPE_GBC;
@@ -210,10 +295,10 @@ void CGameManager::loadCartridge()
 		name[0] = 0;
 		details[0] = 0;
 		if(cartType == CARTRIDGE_TYPE_GBA) {
-			gm_searchFileForDetails(gm_listGBA, gbx_getGameIdentifier(), name, details);
+			gm_searchIndexForDetails(listIndexGBA, gbx_getGameIdentifier(), name, details);
 		} else {
-			if(gm_searchFileForDetails(gm_listGB, gbx_getGameIdentifier(), name, details)) cartType = CARTRIDGE_TYPE_GB;
-			else if(gm_searchFileForDetails(gm_listGBC, gbx_getGameIdentifier(), name, details)) cartType = CARTRIDGE_TYPE_GBC;
+			if(gm_searchIndexForDetails(listIndexGB, gbx_getGameIdentifier(), name, details)) cartType = CARTRIDGE_TYPE_GB;
+			else if(gm_searchIndexForDetails(listIndexGBC, gbx_getGameIdentifier(), name, details)) cartType = CARTRIDGE_TYPE_GBC;
 		}
 		
 		//determine file name
@@ -245,30 +330,33 @@ void CGameManager::loadCartridge()
 		
 		//determine boxart img
 		if(cartType == CARTRIDGE_TYPE_GB) {
-			cartImgBoxart = gm_searchForImage(gm_boxartImgPathGB, cartName, filename, gm_boxartImgDefaultGB);
+			cartImgBoxart = searchForImage(gm_boxartImgPathGB, cartName, filename, gm_boxartImgDefaultGB);
 		} else if(cartType == CARTRIDGE_TYPE_GBC) {
-			cartImgBoxart = gm_searchForImage(gm_boxartImgPathGBC, cartName, filename, gm_boxartImgDefaultGBC);
+			cartImgBoxart = searchForImage(gm_boxartImgPathGBC, cartName, filename, gm_boxartImgDefaultGBC);
 		} else if(cartType == CARTRIDGE_TYPE_GBA) {
-			cartImgBoxart = gm_searchForImage(gm_boxartImgPathGBA, cartName, filename, gm_boxartImgDefaultGBA);
+			cartImgBoxart = searchForImage(gm_boxartImgPathGBA, cartName, filename, gm_boxartImgDefaultGBA);
 		}
 		
 		//determine snap img
 		if(cartType == CARTRIDGE_TYPE_GB) {
-			cartImgSnap = gm_searchForImage(gm_snapImgPathGB, cartName, filename, gm_snapImgDefaultGB);
+			cartImgSnap = searchForImage(gm_snapImgPathGB, cartName, filename, gm_snapImgDefaultGB);
 		} else if(cartType == CARTRIDGE_TYPE_GBC) {
-			cartImgSnap = gm_searchForImage(gm_snapImgPathGBC, cartName, filename, gm_snapImgDefaultGBC);
+			cartImgSnap = searchForImage(gm_snapImgPathGBC, cartName, filename, gm_snapImgDefaultGBC);
 		} else if(cartType == CARTRIDGE_TYPE_GBA) {
-			cartImgSnap = gm_searchForImage(gm_snapImgPathGBA, cartName, filename, gm_snapImgDefaultGBA);
+			cartImgSnap = searchForImage(gm_snapImgPathGBA, cartName, filename, gm_snapImgDefaultGBA);
 		}
 		
 		//determine title img
 		if(cartType == CARTRIDGE_TYPE_GB) {
-			cartImgTitle = gm_searchForImage(gm_titleImgPathGB, cartName, filename, gm_titleImgDefaultGB);
+			cartImgTitle = searchForImage(gm_titleImgPathGB, cartName, filename, gm_titleImgDefaultGB);
 		} else if(cartType == CARTRIDGE_TYPE_GBC) {
-			cartImgTitle = gm_searchForImage(gm_titleImgPathGBC, cartName, filename, gm_titleImgDefaultGBC);
+			cartImgTitle = searchForImage(gm_titleImgPathGBC, cartName, filename, gm_titleImgDefaultGBC);
 		} else if(cartType == CARTRIDGE_TYPE_GBA) {
-			cartImgTitle = gm_searchForImage(gm_titleImgPathGBA, cartName, filename, gm_titleImgDefaultGBA);
+			cartImgTitle = searchForImage(gm_titleImgPathGBA, cartName, filename, gm_titleImgDefaultGBA);
 		}
+		
+		//uncatalogued carts can be dumped ahead of time, keyed by header fingerprint
+		if(stagePrefetch && cartCatalogIndex < 0) stageFingerprint = gbx_readFingerprint();
 	}
 }
 
@@ -311,6 +399,8 @@ int CGameManager::getCartridgeCatalogIndex()
 //! Checks if the cartridge save data has changed since last sync
 int CGameManager::syncCartridgeCheck()
 {
+	verifyConfidence = -1.0f;
+	
 	//check if cartridge valid else try to load new cartridge
 	if(gbx_isLoaded() == 0) {
 		loadCartridge();
@@ -321,6 +411,9 @@ int CGameManager::syncCartridgeCheck()
 	//check if not catalogued
 	if(cartCatalogIndex == -1) return SYNC_CHECK_NOT_CATALOGUED;
 	
+	//make sure the cart really is the catalogued game
+	if(verifySamples > 0 && verifyCartridge(verifySamples, &verifyConfidence) == VERIFY_MISMATCH) return SYNC_CHECK_ERROR_ROM_MISMATCH;
+	
 	//check if there even is a save
 	if(gbx_getSaveSize() == 0) return SYNC_CHECK_SAVE_NONE;
 	
@@ -337,41 +430,120 @@ int CGameManager::syncCartridgeCheck()
 	//check if backup file even exists
 	if(!gm_fileExists(backupFilename)) return SYNC_CHECK_SAVE_CHANGED;
 	
-	//get last known save file
-	char* lastKnownSave = 0;
-	int lastKnownSaveSize = 0;
-	FILE* file = fopen(backupFilename, "rb");
-	if(file != NULL) {
-		fseek(file, 0, SEEK_END);
-		lastKnownSaveSize = ftell(file);
-		rewind(file);
-		lastKnownSave = new char[gbx_getSaveSize()];
-		fread(lastKnownSave, lastKnownSaveSize, 1, file);
-		fclose(file);
+	//map last known save file
+	unsigned int saveSize = gbx_getSaveSize();
+	int fd = open(backupFilename, O_RDONLY);
+	if(fd < 0) return SYNC_CHECK_ERROR_UNKNOWN;
+	struct stat fileStat;
+	if(fstat(fd, &fileStat) != 0 || fileStat.st_size != (off_t)saveSize) {
+		close(fd);
+		return SYNC_CHECK_ERROR_UNKNOWN;
 	}
+	char* lastKnownSave = (char*)mmap(0, saveSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(lastKnownSave == MAP_FAILED) return SYNC_CHECK_ERROR_UNKNOWN;
 	
-	//get current cartridge save data
-	char* currentSave = new char[gbx_getSaveSize()];
-	int currentSaveSize = gbx_readSave(currentSave);
+	//stream the cartridge save in blocks, likely hot spots first, and stop at the first difference
+	unsigned int numBlocks = (saveSize + SAVE_COMPARE_BLOCK_SIZE - 1) / SAVE_COMPARE_BLOCK_SIZE;
+	unsigned int* order = new unsigned int[numBlocks];
+	gm_saveBlockOrder(order, numBlocks);
+	gm_compareState state;
+	state.expected = lastKnownSave;
+	state.blockSize = SAVE_COMPARE_BLOCK_SIZE;
+	state.mismatch = false;
+	int handled = gbx_readSaveBlocks(SAVE_COMPARE_BLOCK_SIZE, order, numBlocks, gm_compareBlock, &state);
 	
 	//check if save has changed
 	int result = SYNC_CHECK_ERROR_UNKNOWN;
-	if(lastKnownSave!=0 && currentSave!=0 && lastKnownSaveSize>0 && currentSaveSize>0 && lastKnownSaveSize==currentSaveSize) {
-		result = SYNC_CHECK_SAVE_UNCHANGED;
-		for(int i=0; i<lastKnownSaveSize; i++) {
-			if(lastKnownSave[i] != currentSave[i]) {
-				result = SYNC_CHECK_SAVE_CHANGED;
-				break;
-			}
-		}
-	}
+	if(state.mismatch) result = SYNC_CHECK_SAVE_CHANGED;
+	else if(handled == (int)numBlocks) result = SYNC_CHECK_SAVE_UNCHANGED;
 	
 	//clear data and finish
-	delete[] lastKnownSave;
-	delete[] currentSave;
+	delete[] order;
+	munmap(lastKnownSave, saveSize);
 	return result;
 }
 	
+//! Gets the confidence of the ROM verify run by the last sync check (negative if none ran)
+float CGameManager::getSyncVerifyConfidence()
+{
+	return verifyConfidence;
+}
+
+//! Checks the cartridge against its catalogued ROM by sampling blocks, falling back to a full compare on mismatch
+int CGameManager::verifyCartridge(int samples, float* confidence)
+{
+	if(confidence) *confidence = 0.0f;
+	if(gbx_isLoaded() == 0) return VERIFY_ERROR_NO_CARTRIDGE;
+	if(cartCatalogIndex == -1) return VERIFY_ERROR_NOT_CATALOGUED;
+	
+	//build file name
+	char romFilename[1024];
+	if(cartType == CARTRIDGE_TYPE_GB) {
+		sprintf(romFilename, "%s%s%s", gm_romPathGB, cartFilename, gm_romExGB);
+	} else if(cartType == CARTRIDGE_TYPE_GBC) {
+		sprintf(romFilename, "%s%s%s", gm_romPathGBC, cartFilename, gm_romExGBC);
+	} else if(cartType == CARTRIDGE_TYPE_GBA) {
+		sprintf(romFilename, "%s%s%s", gm_romPathGBA, cartFilename, gm_romExGBA);
+	}
+	
+	//check the stored rom (only the sampled blocks are read from it)
+	FILE* file = fopen(romFilename, "rb");
+	if(file == NULL) return VERIFY_ERROR_NOT_CATALOGUED;
+	fseek(file, 0, SEEK_END);
+	long romFileSize = ftell(file);
+	unsigned int romSize = gbx_getROMSize();
+	if(romFileSize != (long)romSize || romSize < VERIFY_BLOCK_SIZE) {
+		fclose(file);
+		return VERIFY_MISMATCH;
+	}
+	
+	//pick one random block from each of evenly sized strips so every bank region gets looked at
+	unsigned int blocks = romSize / VERIFY_BLOCK_SIZE;
+	if(samples > (int)blocks) samples = blocks;
+	unsigned int seed = (unsigned int)gm_millis();
+	char* cartBlock = new char[VERIFY_BLOCK_SIZE];
+	char* fileBlock = new char[VERIFY_BLOCK_SIZE];
+	int result = VERIFY_MATCH;
+	for(int i=0; i<samples && result == VERIFY_MATCH; i++) {
+		unsigned int first = (blocks * i) / samples;
+		unsigned int last = (blocks * (i + 1)) / samples;
+		unsigned int start = (first + (rand_r(&seed) % (last - first))) * VERIFY_BLOCK_SIZE;
+		if(fseek(file, start, SEEK_SET) != 0 || fread(fileBlock, VERIFY_BLOCK_SIZE, 1, file) != 1) result = VERIFY_ERROR_NOT_CATALOGUED;
+		else if(gbx_readROMAt(cartBlock, start, VERIFY_BLOCK_SIZE) != VERIFY_BLOCK_SIZE) result = VERIFY_ERROR_NO_CARTRIDGE;
+		else if(memcmp(cartBlock, fileBlock, VERIFY_BLOCK_SIZE) != 0) result = VERIFY_MISMATCH;
+	}
+	delete[] cartBlock;
+	delete[] fileBlock;
+	fclose(file);
+	if(result == VERIFY_MATCH) {
+		//chance that a rom differing in 1% of its blocks would have been caught
+		float miss = 1.0f;
+		for(int i=0; i<samples; i++) miss *= 0.99f;
+		if(confidence) *confidence = 1.0f - miss;
+		return VERIFY_MATCH;
+	}
+	if(result != VERIFY_MISMATCH) return result;
+	
+	//a sample differed so settle it with a full compare (a flaky read shouldn't condemn the cart)
+	int fd = open(romFilename, O_RDONLY);
+	if(fd < 0) return VERIFY_ERROR_NOT_CATALOGUED;
+	char* romData = (char*)mmap(0, romSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(romData == MAP_FAILED) return VERIFY_ERROR_NOT_CATALOGUED;
+	gm_compareState state;
+	state.expected = romData;
+	state.blockSize = GBX_CHUNK_SIZE;
+	state.mismatch = false;
+	int next = gbx_readROMChunks(0, gm_compareBlock, &state);
+	munmap(romData, romSize);
+	if(next < 0) return VERIFY_ERROR_NO_CARTRIDGE;
+	
+	if(confidence) *confidence = 1.0f;
+	if(state.mismatch || (unsigned int)next * GBX_CHUNK_SIZE < romSize) return VERIFY_MISMATCH;
+	return VERIFY_MATCH;
+}
+
 //! Estimates the amount of time to sync the currently connected cartridge
 int CGameManager::syncCartridgeEstimateTime(bool updateCartSave)
 {
@@ -394,24 +566,29 @@ int CGameManager::syncCartridgeEstimateTime(bool updateCartSave)
 	
 	//get ROM if not already saved
 	if(!gm_fileExists(romFilename)) {
-		time += gbx_timeToReadROM();
-		time += (int)(gbx_getROMSize()*0.00029023034);//write file
+		char stageFilename[1024];
+		sprintf(stageFilename, "%s%08x", gm_stagingPath, stageFingerprint);
+		unsigned int staged = 0;
+		if(stageFingerprint != 0) staged = gm_stagedLength(stageFilename, gbx_getROMSize());
+		if(stageJob != 0 && stageWritten > staged) staged = stageWritten;
+		time += (int)((long long)gbx_timeToReadROM() * (gbx_getROMSize() - staged) / gbx_getROMSize());
+		time += gbx_getROMSize()/fileWriteRate;//write file
 	}
 	if(gbx_getSaveSize() > 0) {
 		if(updateCartSave) {
 			
 			//update the cartridge save data
 			if(gm_fileExists(saveFilename)) {
-				time += (int)(gbx_getSaveSize()*0.00001238505);//read file
-				time += (int)(gbx_getSaveSize()*0.00029023034);//write file
+				time += gbx_getSaveSize()/fileReadRate;//read file
+				time += gbx_getSaveSize()/fileWriteRate;//write file
 				time += gbx_timeToWriteSave();
 			}
 		} else {
 			
 			//update the system save data
 			time += gbx_timeToReadSave();
-			time += (int)(gbx_getSaveSize()*0.00029023034);//write file
-			time += (int)(gbx_getSaveSize()*0.00029023034);//write file
+			time += gbx_getSaveSize()/fileWriteRate;//write file
+			time += gbx_getSaveSize()/fileWriteRate;//write file
 		}
 	}
 	
@@ -420,12 +597,19 @@ int CGameManager::syncCartridgeEstimateTime(bool updateCartSave)
 }
 
 //! Syncs the currently connected cartridge to the catalog
-bool CGameManager::syncCartridge(bool updateCartSave)
+bool CGameManager::syncCartridge(bool updateCartSave, float* progress, bool* cancel)
 {
 	//double check the cartridge hasn't changed
 	if(cartType == CARTRIDGE_TYPE_NONE) return false;
 	bool failure = false;
 	
+	//the background dump gives up the bus and hands over what it has
+	stopStaging();
+	char stageFilename[1024];
+	sprintf(stageFilename, "%s%08x", gm_stagingPath, stageFingerprint);
+	char archiveFilename[1024];
+	sprintf(archiveFilename, "%s%s%s", gm_archivePath, cartFilename, gm_archiveEx);
+	
 	//build file names
 	char romFilename[1024];
 	char catalogFilename[1024];
@@ -455,18 +639,42 @@ bool CGameManager::syncCartridge(bool updateCartSave)
 	char* romData = NULL;
 	char* saveData = NULL;
 	
+	//split progress between the rom and save transfers by size
+	bool readROM = !gm_fileExists(romFilename);
+	float progressROM = 0.0f;
+	if(readROM) progressROM = (float)gbx_getROMSize() / (float)(gbx_getROMSize() + gbx_getSaveSize());
+	if(progress) *progress = 0.0f;
+	
 	//get ROM if not already saved
-	if(!gm_fileExists(romFilename)) {
+	if(readROM) {
 		romFile = fopen(romFilename, "w");
 		if(romFile != NULL) {
 			romData = new char[gbx_getROMSize()];
-			if(gbx_readROM(romData) != gbx_getROMSize()) {
-				delete[] romData;
-				romData = NULL;
+			
+			//only read what the background dump didn't get to
+			unsigned int staged = 0;
+			if(stageFingerprint != 0) staged = gm_stagedLength(stageFilename, gbx_getROMSize());
+			if(staged > 0) {
+				FILE* stageFile = fopen(stageFilename, "rb");
+				if(stageFile == NULL || fread(romData, staged, 1, stageFile) != 1) staged = 0;
+				if(stageFile) fclose(stageFile);
+			}
+			
+			//an earlier archive of this cart can supply verified blocks past what was staged
+			unsigned int archived = readArchivedROM(archiveFilename, romData, staged);
+			if(archived > staged) staged = archived;
+			if(staged < (unsigned int)gbx_getROMSize()) {
+				if(gm_waitForJob(gbx_startReadROMFrom(romData, staged / GBX_CHUNK_SIZE), progress, 0.0f, progressROM, cancel) != gbx_getROMSize()) {
+					delete[] romData;
+					romData = NULL;
+				}
 			}
 		}
 		if(romData == NULL) {
-			if(romFile) fclose(romFile);
+			if(romFile) {
+				fclose(romFile);
+				remove(romFilename);
+			}
 			if(saveFile) fclose(saveFile);
 			if(saveBackupFile) fclose(saveBackupFile);
 			if(romData) delete[] romData;
@@ -488,8 +696,10 @@ bool CGameManager::syncCartridge(bool updateCartSave)
 					long savefilelen = ftell(saveFile);
 					rewind(saveFile);
 					if(savefilelen == gbx_getSaveSize()) {
+						long start = gm_millis();
 						saveData = new char[gbx_getSaveSize()];
 						fread(saveData, savefilelen, 1, saveFile);
+						recordFileRate(false, savefilelen, start);
 					}
 				}
 			}
@@ -500,7 +710,7 @@ bool CGameManager::syncCartridge(bool updateCartSave)
 			saveBackupFile = fopen(backupFilename, "w");
 			if(saveFile != NULL && saveBackupFile != NULL) {
 				saveData = new char[gbx_getSaveSize()];
-				if(gbx_readSave(saveData) != gbx_getSaveSize()) {
+				if(gm_waitForJob(gbx_startReadSave(saveData), progress, progressROM, 1.0f - progressROM, cancel) != gbx_getSaveSize()) {
 					delete[] saveData;
 					saveData = NULL;
 				}
@@ -518,7 +728,11 @@ bool CGameManager::syncCartridge(bool updateCartSave)
 	
 	//save ROM data to file
 	if(romData != NULL && romFile != NULL) {
+		long start = gm_millis();
 		for(int i=0; i<gbx_getROMSize(); i++) fputc(romData[i], romFile);
+		fflush(romFile);
+		recordFileRate(true, gbx_getROMSize(), start);
+		if(stageFingerprint != 0) remove(stageFilename);
 		
 		//update catalog
 		cartCatalogIndex = addToCatalog(cartName, catalogFilename, cartImgBoxart);
@@ -529,7 +743,7 @@ bool CGameManager::syncCartridge(bool updateCartSave)
 		
 		//to cartridge
 		if(saveData != NULL && saveBackupFile != NULL) {
-			if(gbx_writeSave(saveData) == gbx_getSaveSize()) {
+			if(gm_waitForJob(gbx_startWriteSave(saveData), progress, progressROM, 1.0f - progressROM, cancel) == gbx_getSaveSize()) {
 				for(int i=0; i<gbx_getSaveSize(); i++) fputc(saveData[i], saveBackupFile);
 			} else {
 				if(romFile) fclose(romFile);
@@ -549,6 +763,12 @@ bool CGameManager::syncCartridge(bool updateCartSave)
 		}
 	}
 	
+	//archive what was read from the cartridge
+	if(archive && romData != NULL) {
+		if(updateCartSave) writeArchive(archiveFilename, romData, NULL);
+		else writeArchive(archiveFilename, romData, saveData);
+	}
+	
 	//clear resources
 	if(romFile) fclose(romFile);
 	if(saveFile) fclose(saveFile);
@@ -559,9 +779,51 @@ bool CGameManager::syncCartridge(bool updateCartSave)
 	return true;
 }
 
+//! Continues the background dump of an uncatalogued cartridge when enabled (call regularly)
+void CGameManager::updateStaging()
+{
+	if(!stagePrefetch || stageStopped || stageFingerprint == 0 || cartType == CARTRIDGE_TYPE_NONE || cartCatalogIndex > -1) return;
+	
+	//start from wherever an earlier dump of this cartridge left off
+	if(stageJob == 0) {
+		char stageFilename[1024];
+		sprintf(stageFilename, "%s%08x", gm_stagingPath, stageFingerprint);
+		stageWritten = gm_stagedLength(stageFilename, gbx_getROMSize());
+		if(stageWritten >= (unsigned int)gbx_getROMSize()) {
+			stageStopped = true;
+			return;
+		}
+		
+		gm_ensureDirectory(gm_stagingPath);
+		if(stageWritten == 0) gm_evictStaging(stageFilename);
+		stageData = new char[gbx_getROMSize()];
+		stageJob = gbx_startStageROM(stageData, stageWritten / GBX_CHUNK_SIZE);
+		if(stageJob == 0) {
+			//bus is busy with another job, try again later
+			delete[] stageData;
+			stageData = 0;
+		}
+		return;
+	}
+	
+	//save progress and clean up once the dump finishes, fails or the cart changes
+	bool done = gbx_jobIsDone(stageJob);
+	flushStaging();
+	if(done) {
+		gbx_jobWait(stageJob);
+		stageJob = 0;
+		delete[] stageData;
+		stageData = 0;
+		stageStopped = true;
+	}
+}
+
 //! Plays the game from the given index in catalog
 void CGameManager::playGame(int index)
 {
+	//don't leave the dump running under the emulator
+	stopStaging();
+	
 	//make sure index is valid
 	if(index < catalogSize && index > -1) {
 
@@ -729,6 +991,7 @@ void CGameManager::removeGame(int index)
 		delete[] oldCatalogFilenames;
 		delete[] oldCatalogImgBoxarts;
 		catalogSize--;
+		saveCatalogCache();
 	}
 }
 	
@@ -824,7 +1087,7 @@ void CGameManager::restoreFromUSB()
 	}
 }
 
-//! Loads up the catalog list
+//! Loads up the catalog list (reusing cached entries for roms that have not changed)
 void CGameManager::loadCatalog()
 {
 	//free resources
@@ -838,6 +1101,28 @@ void CGameManager::loadCatalog()
 	delete[] catalogImgBoxarts;
 	catalogSize = 0;
 	
+	//read the cache (it is used as is when none of the rom folders changed)
+	int numCached = 0;
+	char* cachedFilenames[MAX_ROMS];
+	char* cachedNames[MAX_ROMS];
+	char* cachedBoxarts[MAX_ROMS];
+	unsigned int cachedSizes[MAX_ROMS];
+	int cacheState = gm_readCatalogCache(cachedFilenames, cachedNames, cachedBoxarts, cachedSizes, &numCached);
+	if(cacheState == CATALOG_CACHE_VALID) {
+		if(numCached > 0) {
+			catalogSize = numCached;
+			catalogNames = new char*[numCached];
+			catalogFilenames = new char*[numCached];
+			catalogImgBoxarts = new char*[numCached];
+			for(int i=0; i<numCached; i++) {
+				catalogNames[i] = cachedNames[i];
+				catalogFilenames[i] = cachedFilenames[i];
+				catalogImgBoxarts[i] = cachedBoxarts[i];
+			}
+		}
+		return;
+	}
+	
 	//determine rom files in all folders
 	int numRoms = 0;
 	char* filenames[MAX_ROMS];
@@ -857,37 +1142,102 @@ void CGameManager::loadCatalog()
 			catalogImgBoxarts[i] = 0;
 		}
 		
-		//try to fill names from master lists
-		gm_searchFileForDetails(gm_listGB, gm_romExGB, catalogFilenames, catalogNames, catalogSize);
-		gm_searchFileForDetails(gm_listGBC, gm_romExGBC, catalogFilenames, catalogNames, catalogSize);
-		gm_searchFileForDetails(gm_listGBA, gm_romExGBA, catalogFilenames, catalogNames, catalogSize);
+		//take over cached entries for roms with the same file and size
+		for(int i=0; i<catalogSize; i++) {
+			unsigned int size = gm_catalogFileSize(catalogFilenames[i]);
+			for(int j=0; j<numCached; j++) {
+				if(cachedFilenames[j] != 0 && cachedSizes[j] == size && strcmp(cachedFilenames[j], catalogFilenames[i]) == 0) {
+					catalogNames[i] = cachedNames[j];
+					catalogImgBoxarts[i] = cachedBoxarts[j];
+					delete[] cachedFilenames[j];
+					cachedFilenames[j] = 0;
+					cachedNames[j] = 0;
+					cachedBoxarts[j] = 0;
+					break;
+				}
+			}
+		}
 		
-		//fill remaining names from the filename
+		//gather the roms that still need to be resolved
+		int numResolve = 0;
+		char* resolveFilenames[MAX_ROMS];
+		char* resolveNames[MAX_ROMS];
+		int resolveIndexes[MAX_ROMS];
 		for(int i=0; i<catalogSize; i++) {
 			if(catalogNames[i] == 0) {
-				int len = strlen(catalogFilenames[i]) - strlen(strrchr(catalogFilenames[i], '.'));
-				catalogNames[i] = new char[len+1];
-				for(int j=0; j<len; j++) catalogNames[i][j] = catalogFilenames[i][j];
-				catalogNames[i][len] = 0;
+				resolveFilenames[numResolve] = catalogFilenames[i];
+				resolveNames[numResolve] = 0;
+				resolveIndexes[numResolve] = i;
+				numResolve++;
+			}
+		}
+		
+		//try to fill names from master lists
+		gm_searchIndexForNames(listIndexGB, gm_romExGB, resolveFilenames, resolveNames, numResolve);
+		gm_searchIndexForNames(listIndexGBC, gm_romExGBC, resolveFilenames, resolveNames, numResolve);
+		gm_searchIndexForNames(listIndexGBA, gm_romExGBA, resolveFilenames, resolveNames, numResolve);
+		
+		//fill remaining names from the filename
+		for(int i=0; i<numResolve; i++) {
+			if(resolveNames[i] == 0) {
+				int len = strlen(resolveFilenames[i]) - strlen(strrchr(resolveFilenames[i], '.'));
+				resolveNames[i] = new char[len+1];
+				for(int j=0; j<len; j++) resolveNames[i][j] = resolveFilenames[i][j];
+				resolveNames[i][len] = 0;
 			}
+			catalogNames[resolveIndexes[i]] = resolveNames[i];
 		}
 		
 		//search for boxart
-		for(int i=0; i<catalogSize; i++) {
+		for(int i=0; i<numResolve; i++) {
+			const char* filename = resolveFilenames[i];
+			const char* name = resolveNames[i];
 			char* boxart = 0;
-			if(strcmp(strrchr(catalogFilenames[i], '.'), gm_romExGB)==0) {
-				boxart = gm_searchForImage(gm_boxartImgPathGB, catalogNames[i], catalogFilenames[i], gm_boxartImgDefaultGB);
-			} else if(strcmp(strrchr(catalogFilenames[i], '.'), gm_romExGBC)==0) {
-				boxart = gm_searchForImage(gm_boxartImgPathGBC, catalogNames[i], catalogFilenames[i], gm_boxartImgDefaultGBC);
-			} else if(strcmp(strrchr(catalogFilenames[i], '.'), gm_romExGBA)==0) {
-				boxart = gm_searchForImage(gm_boxartImgPathGBA, catalogNames[i], catalogFilenames[i], gm_boxartImgDefaultGBA);
+			if(strcmp(strrchr(filename, '.'), gm_romExGB)==0) {
+				boxart = searchForImage(gm_boxartImgPathGB, name, filename, gm_boxartImgDefaultGB);
+			} else if(strcmp(strrchr(filename, '.'), gm_romExGBC)==0) {
+				boxart = searchForImage(gm_boxartImgPathGBC, name, filename, gm_boxartImgDefaultGBC);
+			} else if(strcmp(strrchr(filename, '.'), gm_romExGBA)==0) {
+				boxart = searchForImage(gm_boxartImgPathGBA, name, filename, gm_boxartImgDefaultGBA);
 			}
-			catalogImgBoxarts[i] = boxart;
+			catalogImgBoxarts[resolveIndexes[i]] = boxart;
 		}
 		
 		//sort
 		sortCatalog();
 	}
+	
+	//free cached entries for roms that are gone
+	for(int i=0; i<numCached; i++) {
+		delete[] cachedFilenames[i];
+		delete[] cachedNames[i];
+		delete[] cachedBoxarts[i];
+	}
+	saveCatalogCache();
+}
+
+//! Writes the catalog to the cache along with the stamps of everything it was resolved from
+void CGameManager::saveCatalogCache()
+{
+	char tempFilename[MAX_FILENAME_SIZE];
+	sprintf(tempFilename, "%s.tmp", gm_catalogCacheFile);
+	FILE* file = fopen(tempFilename, "w");
+	if(file == NULL) return;
+	
+	long stamps[CATALOG_CACHE_SOURCES*2];
+	gm_catalogStamps(stamps);
+	fprintf(file, "%s\n", gm_catalogCacheMagic);
+	for(int i=0; i<CATALOG_CACHE_SOURCES*2; i++) fprintf(file, i==0 ? "%ld" : " %ld", stamps[i]);
+	fprintf(file, "\n");
+	for(int i=0; i<catalogSize; i++) {
+		fprintf(file, "%u\t%s\t%s\t%s\n", gm_catalogFileSize(catalogFilenames[i]), catalogFilenames[i], catalogNames[i], catalogImgBoxarts[i] ? catalogImgBoxarts[i] : "");
+	}
+	
+	//replace the old cache only once the new one is complete
+	bool written = (fflush(file) == 0);
+	fclose(file);
+	if(written) rename(tempFilename, gm_catalogCacheFile);
+	else remove(tempFilename);
 }
 
 //! Sorts the catalog list
@@ -916,6 +1266,7 @@ int CGameManager::addToCatalog(const char* name, const char* filename, const cha
 	
 	//sort and find index
 	sortCatalog();
+	saveCatalogCache();
 	for(int i=0; i<catalogSize; i++) {
 		if(strcmp(filename, catalogFilenames[i]) == 0) return i;
 	}
@@ -1009,6 +1360,144 @@ void CGameManager::initSettings()
 			break;
 		}
 	}
+	
+	//background dumping of uncatalogued carts (opt-in)
+	stagePrefetch = stmgr->getPropertyInteger(gm_stagePrefetchSetting, 0) > 0;
+	stmgr->setPropertyInteger(gm_stagePrefetchSetting, stagePrefetch ? 1 : 0);
+	
+	//sampled rom check before syncing a catalogued cart (0 turns it off)
+	verifySamples = stmgr->getPropertyInteger(gm_verifySamplesSetting, 0);
+	if(verifySamples < 0) verifySamples = 0;
+	stmgr->setPropertyInteger(gm_verifySamplesSetting, verifySamples);
+	
+	//single file archive of each synced cart (opt-in)
+	archive = stmgr->getPropertyInteger(gm_archiveSetting, 0) > 0;
+	stmgr->setPropertyInteger(gm_archiveSetting, archive ? 1 : 0);
+	
+	//measured file rates (bytes per milli)
+	fileReadRate = stmgr->getPropertyInteger(gm_fileReadRateSetting, 80742);
+	fileWriteRate = stmgr->getPropertyInteger(gm_fileWriteRateSetting, 3445);
+	if(fileReadRate < 1) fileReadRate = 1;
+	if(fileWriteRate < 1) fileWriteRate = 1;
+}
+
+//! Searches the given image folder for the closest match to the rom (default image if none)
+char* CGameManager::searchForImage(const char* dirPath, const char* name, const char* filename, const char* defaultImg)
+{
+	void* index = 0;
+	for(int i=0; gm_imageFolders[i] != 0; i++) {
+		if(strcmp(gm_imageFolders[i], dirPath) == 0) {
+			if(imageIndexes[i] == 0) imageIndexes[i] = imx_open(dirPath, gm_imageIndexes[i]);
+			index = imageIndexes[i];
+			break;
+		}
+	}
+	return gm_searchForImage(index, dirPath, name, filename, defaultImg);
+}
+
+//! Writes a dump container of the cartridge with the given ROM and Save data (save can be null)
+void CGameManager::writeArchive(const char* filename, char* romData, char* saveData)
+{
+	dmp_header header;
+	memset(&header, 0, sizeof(dmp_header));
+	header.cartridgeType = gbx_getCartridgeType();
+	header.memoryType = gbx_getMemoryType();
+	strncpy(header.title, gbx_getGameTitle(), sizeof(header.title) - 1);
+	strncpy(header.identifier, gbx_getGameIdentifier(), sizeof(header.identifier) - 1);
+	header.romSize = gbx_getROMSize();
+	if(saveData != NULL) header.saveSize = gbx_getSaveSize();
+	
+	//streamed out block by block (reads don't retry yet so retry counts are all zero)
+	gm_ensureDirectory(gm_archivePath);
+	dmp_writer* writer = dmp_create(filename, &header);
+	if(writer == 0) return;
+	for(unsigned int i=0; i<header.romSize; i+=DMP_BLOCK_SIZE) {
+		unsigned int length = header.romSize - i;
+		if(length > DMP_BLOCK_SIZE) length = DMP_BLOCK_SIZE;
+		if(dmp_writeROMBlock(writer, romData + i, length, 0) < 0) break;
+	}
+	for(unsigned int i=0; i<header.saveSize; i+=DMP_BLOCK_SIZE) {
+		unsigned int length = header.saveSize - i;
+		if(length > DMP_BLOCK_SIZE) length = DMP_BLOCK_SIZE;
+		if(dmp_writeSaveBlock(writer, saveData + i, length, 0) < 0) break;
+	}
+	if(dmp_close(writer) != 0) remove(filename);
+}
+
+//! Reads verified ROM blocks of a matching archive past what romData already holds (returns the length of the good run from the start of the ROM)
+unsigned int CGameManager::readArchivedROM(const char* filename, char* romData, unsigned int start)
+{
+	dmp_header header;
+	dmp_reader* reader = dmp_openReader(filename, &header);
+	if(reader == 0) return 0;
+	if(header.romSize != (unsigned int)gbx_getROMSize() || strcmp(header.identifier, gbx_getGameIdentifier()) != 0) {
+		dmp_closeReader(reader);
+		return 0;
+	}
+	
+	//stop at the first bad block, the cart read picks up from there (bad blocks leave romData untouched)
+	unsigned int length = (start / DMP_BLOCK_SIZE) * DMP_BLOCK_SIZE;
+	while(length < header.romSize) {
+		int blockLength = dmp_readBlockFrom(reader, DMP_SECTION_ROM, length / DMP_BLOCK_SIZE, romData + length, 0);
+		if(blockLength <= 0) break;
+		length += blockLength;
+	}
+	dmp_closeReader(reader);
+	return (length < header.romSize) ? (length / GBX_CHUNK_SIZE) * GBX_CHUNK_SIZE : length;
+}
+
+//! Stops the background dump, saving everything confirmed so far for resume
+void CGameManager::stopStaging()
+{
+	if(stageJob == 0) return;
+	
+	//the job stops at the next chunk boundary
+	gbx_jobCancel(stageJob);
+	while(!gbx_jobIsDone(stageJob)) {
+		struct timespec ts;
+		ts.tv_sec = 0;
+		ts.tv_nsec = 5 * 1000000;
+		nanosleep(&ts, &ts);
+	}
+	flushStaging();
+	gbx_jobWait(stageJob);
+	stageJob = 0;
+	delete[] stageData;
+	stageData = 0;
+}
+
+//! Appends newly confirmed bytes of the background dump to the staging file
+void CGameManager::flushStaging()
+{
+	//the job publishes its count under a lock, so everything below it is final and safe to read here
+	unsigned int transferred = gbx_jobTransferred(stageJob);
+	if(stageJob == 0 || stageData == 0 || transferred <= stageWritten) return;
+	
+	char stageFilename[1024];
+	sprintf(stageFilename, "%s%08x", gm_stagingPath, stageFingerprint);
+	FILE* stageFile = fopen(stageFilename, stageWritten > 0 ? "r+b" : "wb");
+	if(stageFile == NULL) return;
+	fseek(stageFile, stageWritten, SEEK_SET);
+	if(fwrite(stageData + stageWritten, transferred - stageWritten, 1, stageFile) == 1) stageWritten = transferred;
+	fclose(stageFile);
+}
+
+//! Folds a measured file transfer into the file rate estimates
+void CGameManager::recordFileRate(bool write, long bytes, long startMillis)
+{
+	long duration = gm_millis() - startMillis;
+	if(duration <= 0 || bytes <= 0) return;
+	
+	//exponentially weighted so new units converge within a couple syncs
+	int rate = (int)(bytes / duration);
+	if(rate < 1) rate = 1;
+	if(write) {
+		fileWriteRate = (fileWriteRate + rate) / 2;
+		stmgr->setPropertyInteger(gm_fileWriteRateSetting, fileWriteRate);
+	} else {
+		fileReadRate = (fileReadRate + rate) / 2;
+		stmgr->setPropertyInteger(gm_fileReadRateSetting, fileReadRate);
+	}
 }
 
 //! Makes updates to bios files
@@ -1053,245 +1542,59 @@ static int gm_addRomsInDir(const char* dirPath, const char* fileExt, char** file
 	}
 	return count;
 }
-static bool gm_searchFileForDetails(const char* filePath, const char* identifier, char* dName, char* dDetails) {
-	char buffer[2][FILE_SCAN_BUFFER_SIZE];
-	char* b0 = buffer[0];
-	char* b1 = buffer[1];
-	for(int i=0; i<FILE_SCAN_BUFFER_SIZE; i++) {
-		b0[i] = 0;
-		b1[i] = 0;
-	}
-	
-	//open file and start scanning it
-	FILE* fileptr = fopen(filePath, "rb");
-	fread(b0, 1, FILE_SCAN_BUFFER_SIZE, fileptr);
-	while(fread(b1, 1, FILE_SCAN_BUFFER_SIZE, fileptr) == FILE_SCAN_BUFFER_SIZE) {
-		for(int i=0; i<FILE_SCAN_BUFFER_SIZE; i++) {
-			
-			//start of entry?
-			if(FILE_SCAN_BUFFER_READ(b0, b1, i) == '{') {
-				int start = i;
-				int end = i;
-				for(int j=0; i+j<FILE_SCAN_BUFFER_SIZE*2; j++) {
-					if(FILE_SCAN_BUFFER_READ(b0, b1, i+j) == '}') {
-						end = i+j;
-						break;
-					}
-				}
-				if(end > start) {
-					//get data for entry
-					char serial[MAX_FILENAME_SIZE];
-					char sha1_1k[MAX_FILENAME_SIZE];
-					char name[MAX_FILENAME_SIZE];
-					char details[MAX_FILENAME_SIZE];
-					for(int j=0; j<MAX_FILENAME_SIZE; j++) {
-						serial[j] = 0;
-						sha1_1k[j] = 0;
-						name[j] = 0;
-						details[j] = 0;
-					}
-					for(int j=0; start+j<end; j++) {
-						//read "serial"?
-						if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+0) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+1) == 's' 
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+2) == 'e' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+3) == 'r'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+4) == 'i' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+5) == 'a'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+6) == 'l' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+7) == '"'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+8) == ':') {
-							for(int k=0; start+j+11+k<end && k<(MAX_FILENAME_SIZE-1); k++) {
-								if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+11+k) == '"') break;
-								serial[k] = FILE_SCAN_BUFFER_READ(b0, b1, start+j+11+k);
-							}
-							if(name[0] != 0 && details[0] != 0 && (serial[0] != 0 || sha1_1k[0] != 0)) break;
-						}
-						
-						//read "sha1_1k"?
-						if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+0) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+1) == 's' 
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+2) == 'h' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+3) == 'a'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+4) == '1' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+5) == '_'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+6) == '1' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+7) == 'k'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+8) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+9) == ':') {
-							for(int k=0; start+j+12+k<end && k<(MAX_FILENAME_SIZE-1); k++) {
-								if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+12+k) == '"') break;
-								sha1_1k[k] = FILE_SCAN_BUFFER_READ(b0, b1, start+j+12+k);
-							}
-							if(name[0] != 0 && details[0] != 0 && (serial[0] != 0 || sha1_1k[0] != 0)) break;
-						}
-						
-						//read "name"?
-						if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+0) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+1) == 'n' 
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+2) == 'a' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+3) == 'm'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+4) == 'e' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+5) == '"'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+6) == ':') {
-							for(int k=0; start+j+9+k<end && k<(MAX_FILENAME_SIZE-1); k++) {
-								if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+9+k) == '"') break;
-								name[k] = FILE_SCAN_BUFFER_READ(b0, b1, start+j+9+k);
-							}
-							if(name[0] != 0 && details[0] != 0 && (serial[0] != 0 || sha1_1k[0] != 0)) break;
-						}
-						
-						//read "details"?
-						if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+0) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+1) == 'd' 
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+2) == 'e' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+3) == 't'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+4) == 'a' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+5) == 'i'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+6) == 'l' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+7) == 's'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+8) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+9) == ':') {
-							for(int k=0; start+j+12+k<end && k<(MAX_FILENAME_SIZE-1); k++) {
-								if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+12+k) == '"') break;
-								details[k] = FILE_SCAN_BUFFER_READ(b0, b1, start+j+12+k);
-							}
-							if(name[0] != 0 && details[0] != 0 && (serial[0] != 0 || sha1_1k[0] != 0)) break;
-						}
-					}
-					
-					//identified entry?
-					if(strcmp(identifier, serial) == 0 || strcmp(identifier, sha1_1k) == 0) {
-						strcpy(dName, name);
-						strcpy(dDetails, details);
-						
-						//close file and return
-						fclose(fileptr);
-						return true;
-					}
-				}
-				i = end+1;
-			}
-		}
-		char* tmp = b0;
-		b0 = b1;
-		b1 = tmp;
-	}
-	
-	//close file
-	fclose(fileptr);
-	return false;
-}
-static bool gm_searchFileForDetails(const char* filePath, const char* fileExt, char** catalogFilenames, char** catalogNames, int catalogSize) {
-	char buffer[2][FILE_SCAN_BUFFER_SIZE];
-	char* b0 = buffer[0];
-	char* b1 = buffer[1];
-	for(int i=0; i<FILE_SCAN_BUFFER_SIZE; i++) {
-		b0[i] = 0;
-		b1[i] = 0;
-	}
-	
-	//open file and start scanning it
+static bool gm_searchIndexForDetails(void* index, const char* identifier, char* dName, char* dDetails) {
+	mdb_entry entry;
+	if(!mdb_find(index, MDB_KEY_SERIAL, identifier, &entry) && !mdb_find(index, MDB_KEY_SHA1_1K, identifier, &entry)) return false;
+	snprintf(dName, MAX_FILENAME_SIZE, "%s", entry.name);
+	snprintf(dDetails, MAX_FILENAME_SIZE, "%s", entry.details);
+	return true;
+}
+static bool gm_searchIndexForNames(void* index, const char* fileExt, char** catalogFilenames, char** catalogNames, int catalogSize) {
 	bool foundMatch = false;
-	FILE* fileptr = fopen(filePath, "rb");
-	fread(b0, 1, FILE_SCAN_BUFFER_SIZE, fileptr);
-	while(fread(b1, 1, FILE_SCAN_BUFFER_SIZE, fileptr) == FILE_SCAN_BUFFER_SIZE) {
-		for(int i=0; i<FILE_SCAN_BUFFER_SIZE; i++) {
-			
-			//start of entry?
-			if(FILE_SCAN_BUFFER_READ(b0, b1, i) == '{') {
-				int start = i;
-				int end = i;
-				for(int j=0; i+j<FILE_SCAN_BUFFER_SIZE*2; j++) {
-					if(FILE_SCAN_BUFFER_READ(b0, b1, i+j) == '}') {
-						end = i+j;
-						break;
-					}
-				}
-				if(end > start) {
-					//get data for entry
-					char filename[MAX_FILENAME_SIZE];
-					char name[MAX_FILENAME_SIZE];
-					char details[MAX_FILENAME_SIZE];
-					for(int j=0; j<MAX_FILENAME_SIZE; j++) {
-						filename[j] = 0;
-						name[j] = 0;
-						details[j] = 0;
-					}
-					for(int j=0; start+j<end; j++) {
-						//read "name"?
-						if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+0) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+1) == 'n' 
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+2) == 'a' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+3) == 'm'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+4) == 'e' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+5) == '"'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+6) == ':') {
-							for(int k=0; start+j+9+k<end && k<(MAX_FILENAME_SIZE-1); k++) {
-								if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+9+k) == '"') break;
-								name[k] = FILE_SCAN_BUFFER_READ(b0, b1, start+j+9+k);
-							}
-							if(name[0] != 0 && details[0] != 0) break;
-						}
-						
-						//read "details"?
-						if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+0) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+1) == 'd' 
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+2) == 'e' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+3) == 't'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+4) == 'a' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+5) == 'i'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+6) == 'l' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+7) == 's'
-						&& FILE_SCAN_BUFFER_READ(b0, b1, start+j+8) == '"' && FILE_SCAN_BUFFER_READ(b0, b1, start+j+9) == ':') {
-							for(int k=0; start+j+12+k<end && k<(MAX_FILENAME_SIZE-1); k++) {
-								if(FILE_SCAN_BUFFER_READ(b0, b1, start+j+12+k) == '"') break;
-								details[k] = FILE_SCAN_BUFFER_READ(b0, b1, start+j+12+k);
-							}
-							if(name[0] != 0 && details[0] != 0) break;
-						}
-					}
-					
-					//does name match anything in catalog?
-					sprintf(filename, "%s %s%s", name, details, fileExt);
-					for(int i=0; i<catalogSize; i++) {
-						if(strcmp(filename, catalogFilenames[i]) == 0) {
-							catalogNames[i] = gm_strClone(name);
-							foundMatch = true;
-						}
-					}
-				}
-				i = end+1;
-			}
+	for(int i=0; i<catalogSize; i++) {
+		const char* ext = strrchr(catalogFilenames[i], '.');
+		if(ext == 0 || strcmp(ext, fileExt) != 0) continue;
+		
+		//catalog filenames are "name details" plus extension
+		char key[MAX_FILENAME_SIZE];
+		int len = ext - catalogFilenames[i];
+		if(len >= MAX_FILENAME_SIZE) continue;
+		strncpy(key, catalogFilenames[i], len);
+		key[len] = 0;
+		
+		mdb_entry entry;
+		if(mdb_find(index, MDB_KEY_NAME, key, &entry)) {
+			delete[] catalogNames[i];
+			catalogNames[i] = gm_strClone(entry.name);
+			foundMatch = true;
 		}
-		char* tmp = b0;
-		b0 = b1;
-		b1 = tmp;
 	}
-	
-	//close file
-	fclose(fileptr);
 	return foundMatch;
 }
-static char* gm_searchForImage(const char* dirPath, const char* name, const char* filename, const char* defaultImg) {
+static char* gm_searchForImage(void* index, const char* dirPath, const char* name, const char* filename, const char* defaultImg) {
 	char simpleName[MAX_FILENAME_SIZE];
-	gm_strSimplify(simpleName, name);
+	imx_simplify(simpleName, name);
 	
-	//search the appropriate folder
-	DIR* dir = opendir(dirPath);
-	if(dir != NULL) {
+	//find potential matches in the folder index
+	const char* matches[50];
+	int numMatches = imx_find(index, simpleName, matches, 50);
+	if(numMatches > 0) {
 		
-		//find potential matches
-		char matches[50][MAX_FILENAME_SIZE];
-		int numMatches = 0;
-		struct dirent *dp;
-		while((dp = readdir(dir)) != NULL)	{
-			if((dp->d_type & DT_REG)==DT_REG && strlen(dp->d_name)<MAX_FILENAME_SIZE) {
-				char simpleNameFile[MAX_FILENAME_SIZE];
-				gm_strSimplify(simpleNameFile, dp->d_name);
-				if(gm_strStartsWith(simpleNameFile, simpleName)) {
-					strcpy(matches[numMatches], dp->d_name);
-					numMatches++;
-					if(numMatches == 50) break;
-				}
+		//pick the best match (later candidates only need checking below the best distance so far)
+		const char* bestMatch = matches[0];
+		int bestMatchDistance = gm_strLevenshtein(matches[0], filename, MAX_FILENAME_SIZE);
+		for(int i=1; i<numMatches && bestMatchDistance>0; i++) {
+			int distance = gm_strLevenshtein(matches[i], filename, bestMatchDistance-1);
+			if(distance < bestMatchDistance) {
+				bestMatchDistance = distance;
+				bestMatch = matches[i];
 			}
 		}
-		closedir(dir);
 		
-		//pick the best match
-		if(numMatches > 0) {
-			char* bestMatch = matches[0];
-			int bestMatchDistance = gm_strLevenshtein(matches[0], filename);
-			for(int i=1; i<numMatches; i++) {
-				int distance = gm_strLevenshtein(matches[i], filename);
-				if(distance < bestMatchDistance) {
-					bestMatchDistance = distance;
-					bestMatch = matches[i];
-				}
-				
-			}
-			
-			//create string with full image path
-			char* image = new char[strlen(dirPath)+strlen(bestMatch)+1];
-			sprintf(image, "%s%s", dirPath, bestMatch);
-			return image;
-		}
+		//create string with full image path
+		char* image = new char[strlen(dirPath)+strlen(bestMatch)+1];
+		sprintf(image, "%s%s", dirPath, bestMatch);
+		return image;
 	}
 	
 	//return the default instead
@@ -1303,40 +1606,6 @@ static char* gm_strClone(const char* str) {
 	strcpy(clone, str);
 	return clone;
 }
-static void gm_strSimplify(char* buffer, const char* str) {
-	strcpy(buffer, str);
-	
-	//use _ instead of &
-	gm_strReplace(buffer, '&', '_');
-	
-	//remove !@#$%^&*()-+'\/"?,|<>:
-	gm_strRemove(buffer, ' ');
-	gm_strRemove(buffer, '!');
-	gm_strRemove(buffer, '@');
-	gm_strRemove(buffer, '#');
-	gm_strRemove(buffer, '$');
-	gm_strRemove(buffer, '%');
-	gm_strRemove(buffer, '^');
-	gm_strRemove(buffer, '&');
-	gm_strRemove(buffer, '*');
-	gm_strRemove(buffer, '(');
-	gm_strRemove(buffer, ')');
-	gm_strRemove(buffer, '+');
-	gm_strRemove(buffer, '-');
-	gm_strRemove(buffer, '\'');
-	gm_strRemove(buffer, '\\');
-	gm_strRemove(buffer, '/');
-	gm_strRemove(buffer, '"');
-	gm_strRemove(buffer, '?');
-	gm_strRemove(buffer, ',');
-	gm_strRemove(buffer, '<');
-	gm_strRemove(buffer, '>');
-	gm_strRemove(buffer, '|');
-	gm_strRemove(buffer, ':');
-	
-	//ignore case
-	gm_strToUpper(buffer);
-}
 static void gm_strReplace(char* str, char find, char to) {
 	for(int i=0; str[i]!=0; i++) if(str[i]==find) str[i]=to;
 }
@@ -1354,50 +1623,40 @@ static void gm_strFileSanitize(char* str) {
 	gm_strRemove(str, '?');
 	gm_strRemove(str, '*');
 }
-static void gm_strToUpper(char* str) {
-	for(int i=0; str[i]!=0; i++) if(str[i]>=97&&str[i]<=122) str[i]-=32;
-}
-static bool gm_strStartsWith(const char* str, const char* find) {
-	for(int i=0; str[i]!=0 && find[i]!=0; i++) {
-		if(str[i] != find[i]) return false;
-	}
-	return true;
-}
-static int gm_strLevenshteinDist(int i, int j, const char* s, int ls, const char* t, int lt, int** d) {
-	if (d[i][j] >= 0) return d[i][j];
-
-	int x;
-	if (i == ls) x = lt - j;
-	else if (j == lt) x = ls - i;
-	else if (s[i] == t[j]) x = gm_strLevenshteinDist(i + 1, j + 1, s, ls, t, lt, d);
-	else {
-		x = gm_strLevenshteinDist(i + 1, j + 1, s, ls, t, lt, d);
-
-		int y;
-		if ((y = gm_strLevenshteinDist(i, j + 1, s, ls, t, lt, d)) < x) x = y;
-		if ((y = gm_strLevenshteinDist(i + 1, j, s, ls, t, lt, d)) < x) x = y;
-		x++;
-	}
-	return d[i][j] = x;
-	
-}
-static int gm_strLevenshtein(const char* s, const char* t) {
+static int gm_strLevenshtein(const char* s, const char* t, int maxDistance) {
 	int ls = strlen(s), lt = strlen(t);
+	int over = maxDistance + 1;
+	if(ls - lt > maxDistance || lt - ls > maxDistance || lt >= MAX_FILENAME_SIZE) return over;
 	
-	//create cache
-	int** d = new int*[ls + 1];
-	for(int i=0; i<=ls; i++) {
-		d[i] = new int[lt + 1];
-		for(int j=0; j<=lt; j++) d[i][j] = -1;
+	//two rows of the distance table, only cells within maxDistance of the diagonal are filled
+	int rows[2][MAX_FILENAME_SIZE + 1];
+	int* prev = rows[0];
+	int* curr = rows[1];
+	for(int j=0; j<=lt; j++) prev[j] = (j <= maxDistance) ? j : over;
+	for(int i=1; i<=ls; i++) {
+		int from = (i - maxDistance > 1) ? i - maxDistance : 1;
+		int to = (i + maxDistance < lt) ? i + maxDistance : lt;
+		curr[0] = (i <= maxDistance) ? i : over;
+		if(from > 1) curr[from-1] = over;
+		
+		int rowMin = curr[0];
+		for(int j=from; j<=to; j++) {
+			int x = prev[j-1] + (s[i-1] == t[j-1] ? 0 : 1);
+			if(prev[j] + 1 < x) x = prev[j] + 1;
+			if(curr[j-1] + 1 < x) x = curr[j-1] + 1;
+			if(x > over) x = over;
+			curr[j] = x;
+			if(x < rowMin) rowMin = x;
+		}
+		if(to < lt) curr[to+1] = over;
+		
+		//stop once every path is already over the cutoff
+		if(rowMin > maxDistance) return over;
+		int* swap = prev;
+		prev = curr;
+		curr = swap;
 	}
- 
-	int dist = gm_strLevenshteinDist(0, 0, s, ls, t, lt, (int**)d);
-	
-	//delete cache
-	for(int i=0; i<=ls; i++) delete[] d[i];
-	delete[] d;
-	
-	return dist;
+	return prev[lt];
 }
 static bool gm_fileExists(const char* filename) {
     FILE *file;
@@ -1464,3 +1723,158 @@ static int gm_compareCatalogElements(const void* elem1, const void* elem2) {
 	//otherwise go by filename
 	return strcmp(filename1, filename2);
 }
+static int gm_waitForJob(gbx_job* job, float* progress, float progressStart, float progressScale, bool* cancel) {
+	if(job == 0) return GBX_ERROR_BUSY;
+	
+	//poll the job while it runs on its worker thread
+	while(!gbx_jobIsDone(job)) {
+		if(cancel && *cancel) gbx_jobCancel(job);
+		if(progress) *progress = progressStart + gbx_jobProgress(job)*progressScale;
+		
+		struct timespec ts;
+		ts.tv_sec = 0;
+		ts.tv_nsec = 50 * 1000000;
+		nanosleep(&ts, &ts);
+	}
+	if(progress) *progress = progressStart + gbx_jobProgress(job)*progressScale;
+	return gbx_jobWait(job);
+}
+static int gm_compareBlock(char* block, unsigned int blockIndex, unsigned int length, void* param) {
+	gm_compareState* state = (gm_compareState*)param;
+	if(memcmp(block, state->expected + (blockIndex * state->blockSize), length) != 0) state->mismatch = true;
+	return state->mismatch;
+}
+static void gm_saveBlockOrder(unsigned int* order, unsigned int count) {
+	unsigned int bits = 0;
+	while((1u << bits) < count) bits++;
+	
+	//bit reversed order visits the start, then the halves, quarters, eighths... where save slots tend to begin
+	unsigned int index = 0;
+	for(unsigned int i=0; i<(1u << bits); i++) {
+		unsigned int reversed = 0;
+		for(unsigned int b=0; b<bits; b++) if(i & (1u << b)) reversed |= 1u << (bits - 1 - b);
+		if(reversed < count) order[index++] = reversed;
+	}
+}
+static long gm_millis() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+static unsigned int gm_stagedLength(const char* filename, unsigned int romSize) {
+	FILE* file = fopen(filename, "rb");
+	if(file == NULL) return 0;
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fclose(file);
+	
+	//a complete dump, otherwise only whole chunks count
+	if(length <= 0) return 0;
+	if((unsigned int)length >= romSize) return romSize;
+	return (length / GBX_CHUNK_SIZE) * GBX_CHUNK_SIZE;
+}
+static void gm_evictStaging(const char* keepFilename) {
+	//carts that never get synced leave their dumps behind, so only the most recent few are kept
+	while(true) {
+		DIR* dir = opendir(gm_stagingPath);
+		if(dir == NULL) return;
+		
+		int count = 0;
+		time_t oldestTime = 0;
+		char oldest[1024] = {0};
+		struct dirent *dp;
+		while((dp = readdir(dir)) != NULL) {
+			if((dp->d_type & DT_REG) != DT_REG) continue;
+			char filename[1024];
+			snprintf(filename, sizeof(filename), "%s%s", gm_stagingPath, dp->d_name);
+			if(strcmp(filename, keepFilename) == 0) continue;
+			
+			struct stat st;
+			if(stat(filename, &st) != 0) continue;
+			if(count == 0 || st.st_mtime < oldestTime) {
+				oldestTime = st.st_mtime;
+				strcpy(oldest, filename);
+			}
+			count++;
+		}
+		closedir(dir);
+		
+		//leave room for the file about to be started
+		if(count < MAX_STAGING_FILES || remove(oldest) != 0) return;
+	}
+}
+static int gm_readCatalogCache(char** filenames, char** names, char** boxarts, unsigned int* sizes, int* count) {
+	*count = 0;
+	FILE* file = fopen(gm_catalogCacheFile, "r");
+	if(file == NULL) return CATALOG_CACHE_INVALID;
+	
+	//compare stamps (boxart and list changes invalidate every entry, rom folder changes only some)
+	char line[MAX_FILENAME_SIZE*4];
+	long stamps[CATALOG_CACHE_SOURCES*2];
+	gm_catalogStamps(stamps);
+	bool valid = (fgets(line, sizeof(line), file) != NULL && strncmp(line, gm_catalogCacheMagic, strlen(gm_catalogCacheMagic)) == 0);
+	bool romsChanged = false;
+	for(int i=0; i<CATALOG_CACHE_SOURCES*2 && valid; i++) {
+		long stamp;
+		if(fscanf(file, "%ld", &stamp) != 1) valid = false;
+		else if(stamp != stamps[i] && i < CATALOG_CACHE_ROM_SOURCES*2) romsChanged = true;
+		else if(stamp != stamps[i]) valid = false;
+	}
+	if(valid && fgets(line, sizeof(line), file) == NULL) valid = false;
+	
+	//read entries as "size, filename, name, boxart" separated by tabs
+	while(valid && *count < MAX_ROMS && fgets(line, sizeof(line), file) != NULL) {
+		char* fields[4];
+		int numFields = 0;
+		char* field = line;
+		line[strcspn(line, "\r\n")] = 0;
+		while(numFields < 4 && field != 0) {
+			fields[numFields++] = field;
+			field = strchr(field, '\t');
+			if(field != 0) *(field++) = 0;
+		}
+		if(numFields < 4) {
+			valid = false;
+			break;
+		}
+		sizes[*count] = strtoul(fields[0], 0, 10);
+		filenames[*count] = gm_strClone(fields[1]);
+		names[*count] = gm_strClone(fields[2]);
+		boxarts[*count] = gm_strClone(fields[3]);
+		(*count)++;
+	}
+	fclose(file);
+	
+	if(!valid) {
+		for(int i=0; i<*count; i++) {
+			delete[] filenames[i];
+			delete[] names[i];
+			delete[] boxarts[i];
+		}
+		*count = 0;
+		return CATALOG_CACHE_INVALID;
+	}
+	if(romsChanged) return CATALOG_CACHE_ROMS_CHANGED;
+	return CATALOG_CACHE_VALID;
+}
+static void gm_catalogStamps(long* stamps) {
+	for(int i=0; i<CATALOG_CACHE_SOURCES; i++) {
+		struct stat st;
+		stamps[i*2] = 0;
+		stamps[i*2 + 1] = 0;
+		if(stat(gm_catalogCacheSources[i], &st) == 0) {
+			stamps[i*2] = st.st_mtim.tv_sec;
+			stamps[i*2 + 1] = st.st_mtim.tv_nsec;
+		}
+	}
+}
+static unsigned int gm_catalogFileSize(const char* filename) {
+	char path[1024];
+	if(strcmp(strrchr(filename, '.'), gm_romExGB)==0) sprintf(path, "%s%s", gm_romPathGB, filename);
+	else if(strcmp(strrchr(filename, '.'), gm_romExGBC)==0) sprintf(path, "%s%s", gm_romPathGBC, filename);
+	else sprintf(path, "%s%s", gm_romPathGBA, filename);
+	
+	struct stat st;
+	if(stat(path, &st) != 0) return 0;
+	return st.st_size;
+}
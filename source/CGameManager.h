@@ -18,6 +18,12 @@
 #define SYNC_CHECK_ERROR_NO_CARTRIDGE -1
 #define SYNC_CHECK_ERROR_CARTRIDGE_CHANGED -2
 #define SYNC_CHECK_ERROR_UNKNOWN -3
+#define SYNC_CHECK_ERROR_ROM_MISMATCH -4
+
+#define VERIFY_MATCH 1
+#define VERIFY_MISMATCH 0
+#define VERIFY_ERROR_NOT_CATALOGUED -1
+#define VERIFY_ERROR_NO_CARTRIDGE -2
 
 class CSettingsManager;
 
@@ -55,11 +61,20 @@ public:
 	//! Checks if the cartridge save data has changed since last sync
 	int syncCartridgeCheck();
 	
+	//! Gets the confidence of the ROM verify run by the last sync check (negative if none ran)
+	float getSyncVerifyConfidence();
+	
+	//! Checks the cartridge against its catalogued ROM by sampling blocks, falling back to a full compare on mismatch
+	int verifyCartridge(int samples, float* confidence);
+	
 	//! Estimates the amount of time to sync the currently connected cartridge
 	int syncCartridgeEstimateTime(bool updateCartSave);
 	
-	//! Syncs the currently connected cartridge to the catalog
-	bool syncCartridge(bool updateCartSave);
+	//! Syncs the currently connected cartridge to the catalog (reports progress and watches for cancel when given)
+	bool syncCartridge(bool updateCartSave, float* progress, bool* cancel);
+	
+	//! Continues the background dump of an uncatalogued cartridge when enabled (call regularly)
+	void updateStaging();
 	
 	//! Plays the game from the given index in catalog
 	void playGame(int index);
@@ -123,18 +138,43 @@ private:
 	char* cartImgSnap;
 	char* cartImgTitle;
 	
+	void* listIndexGB;
+	void* listIndexGBC;
+	void* listIndexGBA;
+	void** imageIndexes;
+	
 	int catalogSize;
 	char** catalogNames;
 	char** catalogFilenames;
 	char** catalogImgBoxarts;
 	
+	int fileReadRate;
+	int fileWriteRate;
+	
+	int verifySamples;
+	float verifyConfidence;
+	bool archive;
+	bool stagePrefetch;
+	bool stageStopped;
+	void* stageJob;
+	char* stageData;
+	unsigned int stageFingerprint;
+	unsigned int stageWritten;
+	
 	//Util functions
 	void loadCatalog();
+	void saveCatalogCache();
 	void sortCatalog();
 	int addToCatalog(const char* name, const char* filename, const char* boxartImg);
 	void findAvailableEmulators();
 	void initSettings();
+	void recordFileRate(bool write, long bytes, long startMillis);
+	void writeArchive(const char* filename, char* romData, char* saveData);
+	unsigned int readArchivedROM(const char* filename, char* romData, unsigned int start);
+	void stopStaging();
+	void flushStaging();
 	void updateBIOS();
+	char* searchForImage(const char* dirPath, const char* name, const char* filename, const char* defaultImg);
 };
 
 #endif
@@ -8,22 +8,25 @@
 
 //! Main Constructor
 CImageSceneNode::CImageSceneNode(CSceneManager* smgr)
-	: CSceneNode(smgr), size(0,0), shadow(false), img(0)
+	: CSceneNode(smgr), size(0,0), shadow(false), img(0), request(0), requestSmallNode(0), requestTop(0), requestTopOpaque(0), requestSmooth(false)
 {
 }
 
 //! Destructor
 CImageSceneNode::~CImageSceneNode()
 {
+	cancelImage();
 	vid_clearTexture(img);
 }
 
 //! Sets the image to use
 void CImageSceneNode::setImage(const char* filename, Vector size, bool smooth)
 {
+	cancelImage();
 	this->size = size;
 	
 	//load image
+	markDirty();
 	vid_clearTexture(img);
 	if(filename) img = vid_generateImageTexture(filename, size.X, size.Y, smooth);
 	else img = 0;
@@ -32,37 +35,137 @@ void CImageSceneNode::setImage(const char* filename, Vector size, bool smooth)
 //! Sets the image to use
 void CImageSceneNode::setImageLayered(const char* filenameBase, const char* filenameTop, unsigned char topOpaque, Vector size, bool smooth)
 {
+	cancelImage();
 	this->size = size;
 	
 	//load image
+	markDirty();
 	vid_clearTexture(img);
 	if(filenameBase && filenameTop) {
 		img = vid_generateImageTexture(filenameBase, size.X, size.Y, smooth);
-		vid_compositeImageToTexture(img, filenameTop, topOpaque, smooth);
+		img = vid_compositeImageToTexture(img, filenameTop, topOpaque, smooth);
 	} else {
 		img = 0;
 	}
 }
 
+//! Sets the image to use here and a smaller copy on another node (decoded once)
+void CImageSceneNode::setImage(const char* filename, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth)
+{
+	cancelImage();
+	this->size = size;
+	smallNode->size = smallSize;
+	
+	//load both sizes in one pass
+	markDirty();
+	smallNode->markDirty();
+	vid_clearTexture(img);
+	vid_clearTexture(smallNode->img);
+	if(filename) {
+		int w[2] = { size.X, smallSize.X };
+		int h[2] = { size.Y, smallSize.Y };
+		VidTexture* textures[2];
+		vid_generateImageTextures(filename, 2, w, h, smooth, textures);
+		img = textures[0];
+		smallNode->img = textures[1];
+	} else {
+		img = 0;
+		smallNode->img = 0;
+	}
+}
+
+//! Sets the image to use here and a smaller copy on another node (decoded once)
+void CImageSceneNode::setImageLayered(const char* filenameBase, const char* filenameTop, unsigned char topOpaque, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth)
+{
+	if(filenameBase && filenameTop) {
+		setImage(filenameBase, size, smallNode, smallSize, smooth);
+		img = vid_compositeImageToTexture(img, filenameTop, topOpaque, smooth);
+		smallNode->img = vid_compositeImageToTexture(smallNode->img, filenameTop, topOpaque, smooth);
+	} else {
+		setImage(0, size, smallNode, smallSize, smooth);
+	}
+}
+
 //! Sets the image to use
 void CImageSceneNode::setImageLayered(const char* filename, Color color, unsigned char colorOpaque, Vector size, bool smooth)
 {
+	cancelImage();
 	this->size = size;
 	
 	//load image
+	markDirty();
 	vid_clearTexture(img);
 	if(filename) {
 		img = vid_generateImageTexture(filename, size.X, size.Y, smooth);
-		vid_compositeColorToTexture(img, color.Red, color.Green, color.Blue, colorOpaque);
+		img = vid_compositeColorToTexture(img, color.Red, color.Green, color.Blue, colorOpaque);
 	} else {
 		img = 0;
 	}
 }
 
+//! Sets the image to use here and a smaller copy on another node, showing a placeholder until it loads in the background
+void CImageSceneNode::requestImage(const char* filename, const char* placeholder, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth)
+{
+	requestImageLayered(filename, 0, 0, placeholder, size, smallNode, smallSize, smooth);
+}
+
+//! Sets the image to use here and a smaller copy on another node, showing a placeholder until it loads in the background
+void CImageSceneNode::requestImageLayered(const char* filenameBase, const char* filenameTop, unsigned char topOpaque, const char* placeholder, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth)
+{
+	//placeholder first (falls back to loading right away if the request can't be queued)
+	if(filenameTop) setImageLayered(placeholder, filenameTop, topOpaque, size, smallNode, smallSize, smooth);
+	else setImage(placeholder, size, smallNode, smallSize, smooth);
+	if(filenameBase == 0 || filenameBase == placeholder) return;
+	int w[2] = { size.X, smallSize.X };
+	int h[2] = { size.Y, smallSize.Y };
+	request = vid_requestImageTextures(filenameBase, 2, w, h, smooth);
+	if(request == 0) {
+		if(filenameTop) setImageLayered(filenameBase, filenameTop, topOpaque, size, smallNode, smallSize, smooth);
+		else setImage(filenameBase, size, smallNode, smallSize, smooth);
+		return;
+	}
+	requestSmallNode = smallNode;
+	requestTop = filenameTop;
+	requestTopOpaque = topOpaque;
+	requestSmooth = smooth;
+}
+
+//! Swaps in a requested image once it has loaded (returns true while still loading)
+bool CImageSceneNode::updateImage()
+{
+	if(request == 0) return false;
+	VidTexture* textures[2];
+	int result = vid_collectImageTextures(request, textures);
+	if(result == 0) return true;
+	request = 0;
+	
+	//an unknown request was dropped along with the video state, keep the placeholder
+	if(result < 0) return false;
+	markDirty();
+	requestSmallNode->markDirty();
+	vid_clearTexture(img);
+	vid_clearTexture(requestSmallNode->img);
+	img = textures[0];
+	requestSmallNode->img = textures[1];
+	if(requestTop) {
+		img = vid_compositeImageToTexture(img, requestTop, requestTopOpaque, requestSmooth);
+		requestSmallNode->img = vid_compositeImageToTexture(requestSmallNode->img, requestTop, requestTopOpaque, requestSmooth);
+	}
+	return false;
+}
+
+//! Cancels a requested image that has not loaded yet
+void CImageSceneNode::cancelImage()
+{
+	if(request) vid_cancelImageTextures(request);
+	request = 0;
+}
+
 //! Sets if image should have a shadow
 void CImageSceneNode::setShadow(bool shadow)
 {
 	this->shadow = shadow;
+	markDirty();
 }
 
 //! Gets the size of the image
@@ -82,16 +185,6 @@ void CImageSceneNode::render()
 {
 	if(img) vid_drawTexture(img, pos.X, pos.Y);
 	if(shadow) {
-		Color falloff1 = Color(30,30,30);
-		vid_drawBox(pos.X-1, pos.Y-1, size.X+2, 1, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X-1, pos.Y+size.Y, size.X+2, 1, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X-1, pos.Y-1, 1, size.Y+2, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X+size.X, pos.Y-1, 1, size.Y+2, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		
-		Color falloff2 = Color(40,40,40);
-		vid_drawBox(pos.X, pos.Y-2, size.X, 1, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X, pos.Y+size.Y+1, size.X, 1, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X-2, pos.Y, 1, size.Y, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X+size.X+1, pos.Y, 1, size.Y, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
+		drawFrame(VID_FRAME_SHADOW, size, Color(0,0,0));
 	}
 }
@@ -27,9 +27,27 @@ public:
 	//! Sets the image to use
 	void setImageLayered(const char* filenameBase, const char* filenameTop, unsigned char topOpaque, Vector size, bool smooth);
 	
+	//! Sets the image to use here and a smaller copy on another node (decoded once)
+	void setImage(const char* filename, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth);
+	
+	//! Sets the image to use here and a smaller copy on another node (decoded once)
+	void setImageLayered(const char* filenameBase, const char* filenameTop, unsigned char topOpaque, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth);
+	
 	//! Sets the image to use
 	void setImageLayered(const char* filename, Color color, unsigned char colorOpaque, Vector size, bool smooth);
 	
+	//! Sets the image to use here and a smaller copy on another node, showing a placeholder until it loads in the background
+	void requestImage(const char* filename, const char* placeholder, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth);
+	
+	//! Sets the image to use here and a smaller copy on another node, showing a placeholder until it loads in the background
+	void requestImageLayered(const char* filenameBase, const char* filenameTop, unsigned char topOpaque, const char* placeholder, Vector size, CImageSceneNode* smallNode, Vector smallSize, bool smooth);
+	
+	//! Swaps in a requested image once it has loaded (returns true while still loading)
+	bool updateImage();
+	
+	//! Cancels a requested image that has not loaded yet
+	void cancelImage();
+	
 	//! Sets if image should have a shadow
 	void setShadow(bool shadow);
 
@@ -46,6 +64,11 @@ private:
 	Vector size;
 	bool shadow;
 	VidTexture* img;
+	int request;
+	CImageSceneNode* requestSmallNode;
+	const char* requestTop;
+	unsigned char requestTopOpaque;
+	bool requestSmooth;
 };
 
 #endif
@@ -14,8 +14,10 @@
 #include <vid.h>
 #include <inp.h>
 #include <time.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <pthread.h>
 
@@ -23,16 +25,30 @@
 static const char* mm_emulatorSettingGB = "game.gb.emulator";
 static const char* mm_emulatorSettingGBA = "game.gba.emulator";
 static const char* mm_resolutionSetting = "system.resolution";
+static const char* mm_placeholderArtGB = "data/img/box_gb.png";
+static const char* mm_placeholderArtGBC = "data/img/box_gbc.png";
+static const char* mm_placeholderArtGBA = "data/img/box_gba.png";
 
 //Progress Bar Thread
 static void* mm_processProgressBar(void* args);
 
+//Frame timing
+static double mm_getTime();
+static void mm_sleepUntil(double time);
+
+//Carousel art
+static const char* mm_getPlaceholderArt(const char* art);
+
 //! Main constructor
 CMenuManager::CMenuManager(CSceneManager* smgr, CSettingsManager* stmgr)
 {
 	this->smgr = smgr;
 	this->stmgr = stmgr;
-	time = clock();
+	nextFrameTime = mm_getTime();
+	frameCountTime = nextFrameTime;
+	frameCount = 0;
+	frameMillis = 0;
+	framesPerSecond = 0;
 	
 	//load assets
 	loadSceneAssets();
@@ -176,7 +192,12 @@ void CMenuManager::loadSceneAssets()
 	//Animation data
 	cursorTarget = 0;
 	carouselTargetX = 0;
+	showProgressBarSceneNodes = 0;
 	showProgressBarSceneNodeLayers = 0;
+	showProgressBarSceneNodeCount = 0;
+	carouselLoading = false;
+	prefetchPage = -1;
+	prefetchCount = 0;
 	
 	//Default page state
 	clearPageSpecificNodes();
@@ -185,7 +206,9 @@ void CMenuManager::loadSceneAssets()
 //! Clears all scene related data and vid assets
 void CMenuManager::clearSceneAssets()
 {
+	delete[] showProgressBarSceneNodes;
 	delete[] showProgressBarSceneNodeLayers;
+	cancelPrefetch();
 	smgr->clearScene();
 }
 
@@ -410,8 +433,9 @@ int CMenuManager::showModal(const char* text1, const char* text2, const char** b
 	}
 	
 	//record current state of scene nodes
-	unsigned char* sceneNodeLayers = new unsigned char[smgr->getSceneNodeCount()];
-	for(int i=0; i<smgr->getSceneNodeCount(); i++) sceneNodeLayers[i] = smgr->getSceneNodes()[i]->getLayer();
+	CSceneNode* sceneNodes[MAX_NUM_NODES];
+	unsigned char sceneNodeLayers[MAX_NUM_NODES];
+	unsigned int sceneNodeCount = smgr->saveLayers(sceneNodes, sceneNodeLayers, MAX_NUM_NODES);
 	
 	//setup modal sizes
 	int padding = 20;
@@ -474,7 +498,7 @@ int CMenuManager::showModal(const char* text1, const char* text2, const char** b
 	this->render();
 	
 	//hide everything except the changeable elements
-	for(int i=0; i<smgr->getSceneNodeCount(); i++) smgr->getSceneNodes()[i]->setLayer(LAYER_HIDDEN);
+	smgr->hideAll();
 	background->setSize(Vector(vid_getScreenWidth(),90));
 	background->setPosition(Vector(0,vid_getScreenHeight()-90));
 	background->setLayer(1);
@@ -502,11 +526,13 @@ int CMenuManager::showModal(const char* text1, const char* text2, const char** b
 			if(inp_getButtonState(INP_BTN_LF) == 1 && numButtons > 0 && selection > 0) {
 				selection--;
 				cursorTarget = modalButton[selection];
+				startCursorAnimation();
 				abtnText->setText(buttonDesc[selection], COLOR_WHITE, COLOR_DARKGRAY, 24, false);
 			}
 			if(inp_getButtonState(INP_BTN_RT) == 1 && numButtons > 0 && selection < numButtons-1) {
 				selection++;
 				cursorTarget = modalButton[selection];
+				startCursorAnimation();
 				abtnText->setText(buttonDesc[selection], COLOR_WHITE, COLOR_DARKGRAY, 24, false);
 			}
 			
@@ -525,20 +551,21 @@ int CMenuManager::showModal(const char* text1, const char* text2, const char** b
 	abtnText->setText(navAText, COLOR_WHITE, COLOR_DARKGRAY, 24, false);
 	background->setSize(Vector(vid_getScreenWidth(),vid_getScreenHeight()));
 	background->setPosition(Vector(0,0));
-	for(int i=0; i<smgr->getSceneNodeCount(); i++) smgr->getSceneNodes()[i]->setLayer(sceneNodeLayers[i]);
-	delete[] sceneNodeLayers;
+	smgr->restoreLayers(sceneNodes, sceneNodeLayers, sceneNodeCount);
 	
 	//return the user selection
 	return selection;
 }
 	
-//! Displays the progress bar and starts the async update process
-void CMenuManager::showProgressBar(const char* text, int estimatedDuration)
+//! Displays the progress bar and starts the async update process (progress and cancel are optional)
+void CMenuManager::showProgressBar(const char* text, int estimatedDuration, const float* progress, bool* cancel)
 {
 	//record current state of scene nodes
+	delete[] showProgressBarSceneNodes;
 	delete[] showProgressBarSceneNodeLayers;
+	showProgressBarSceneNodes = new CSceneNode*[smgr->getSceneNodeCount()];
 	showProgressBarSceneNodeLayers = new unsigned char[smgr->getSceneNodeCount()];
-	for(int i=0; i<smgr->getSceneNodeCount(); i++) showProgressBarSceneNodeLayers[i] = smgr->getSceneNodes()[i]->getLayer();
+	showProgressBarSceneNodeCount = smgr->saveLayers(showProgressBarSceneNodes, showProgressBarSceneNodeLayers, smgr->getSceneNodeCount());
 	
 	//setup progress bar
 	dpadIcon->setLayer(LAYER_HIDDEN);
@@ -547,6 +574,13 @@ void CMenuManager::showProgressBar(const char* text, int estimatedDuration)
 	abtnText->setLayer(LAYER_HIDDEN);
 	bbtnIcon->setLayer(LAYER_HIDDEN);
 	bbtnText->setLayer(LAYER_HIDDEN);
+	if(cancel) {
+		bbtnIcon->setPosition(Vector(dpadIcon->getPosition().X, bbtnIcon->getPosition().Y));
+		bbtnIcon->setLayer(5);
+		bbtnText->setText("Cancel", COLOR_WHITE, COLOR_DARKGRAY, 24, false);
+		bbtnText->setPosition(Vector(bbtnIcon->getPosition().X+37, bbtnText->getPosition().Y));
+		bbtnText->setLayer(5);
+	}
 	loadingText->setText(text, COLOR_WHITE, COLOR_DARKGRAY, 24, false);
 	loadingText->setPosition(Vector(vid_getScreenWidth()-(loadingText->getSize().X+screenMargin+loadingBar->getSize().X+10), loadingText->getPosition().Y));
 	loadingText->setLayer(5);
@@ -560,7 +594,7 @@ void CMenuManager::showProgressBar(const char* text, int estimatedDuration)
 	this->render();
 	
 	//hide everything except the changeable elements
-	for(int i=0; i<smgr->getSceneNodeCount(); i++) smgr->getSceneNodes()[i]->setLayer(LAYER_HIDDEN);
+	smgr->hideAll();
 	
 	//start progress draw thread
 	endProgressBarThread = false;
@@ -568,13 +602,15 @@ void CMenuManager::showProgressBar(const char* text, int estimatedDuration)
 	int posY = loadingBar->getPosition().Y;
 	int sizeX = loadingBar->getSize().X;
 	int sizeY = loadingBar->getSize().Y;
-	void* params[6];
+	void* params[8];
 	params[0] = (void*)(&endProgressBarThread);
 	params[1] = (void*)(&estimatedDuration);
 	params[2] = (void*)(&posX);
 	params[3] = (void*)(&posY);
 	params[4] = (void*)(&sizeX);
 	params[5] = (void*)(&sizeY);
+	params[6] = (void*)progress;
+	params[7] = (void*)cancel;
 	pthread_t progressBarThreadId; 
     pthread_create(&progressBarThreadId, NULL, mm_processProgressBar, (void*)params);
 }
@@ -585,10 +621,13 @@ void CMenuManager::endProgressBar()
 	//end thread
 	endProgressBarThread = true;
 	
-	//clean up state
-	for(int i=0; i<smgr->getSceneNodeCount(); i++) smgr->getSceneNodes()[i]->setLayer(showProgressBarSceneNodeLayers[i]);
+	//clean up state (the bar was drawn outside the scene)
+	smgr->restoreLayers(showProgressBarSceneNodes, showProgressBarSceneNodeLayers, showProgressBarSceneNodeCount);
+	delete[] showProgressBarSceneNodes;
 	delete[] showProgressBarSceneNodeLayers;
+	showProgressBarSceneNodes = 0;
 	showProgressBarSceneNodeLayers = 0;
+	smgr->invalidate();
 }
 	
 //! Shows the given text in the bottom right corner until selection or page is changed
@@ -698,6 +737,8 @@ void CMenuManager::setPageSelection(int selection, bool noAnimation)
 			cursor->setPosition(cursorTarget->getPosition());
 			cursor->setSize(cursorTarget->getSize());
 			cursorTarget = 0;
+		} else {
+			startCursorAnimation();
 		}
 	} else {
 		selectionState = MENU_SELECTION_STATE_NONE;
@@ -786,42 +827,27 @@ int CMenuManager::getCatalogIndex()
 //! Renders the menu
 void CMenuManager::render()
 {
-	//sleep to maintain MENU_FRAME_RATE
-	long currTime = clock();
-	double diff = (double)(currTime - time) / CLOCKS_PER_SEC;
-	if(diff < (1.0/MENU_FRAME_RATE)) {
-		long usec = ((1.0/MENU_FRAME_RATE) - diff)*1000*1000;
-		struct timespec ts;
-		ts.tv_sec = usec / 1000000;
-		ts.tv_nsec = (usec % 1000000) * 1000;
-		nanosleep(&ts, &ts);
-	}
+	double frameStartTime = mm_getTime();
 	
 	//settings page values
 	if(pageState == MENU_PAGE_STATE_SETTINGS) updateSettings();
 	
-	//cursor animation
+	//carousel images arriving from the background
+	if(carouselLoading) updateCarouselImages();
+	
+	//cursor animation (follows the target in case it is moving too)
 	if(cursorTarget) {
-		cursor->setPosition((cursor->getPosition()+cursorTarget->getPosition()*3)/4);
-		cursor->setSize((cursor->getSize()+cursorTarget->getSize()*3)/4);
-		if(abs(cursor->getPosition().X - cursorTarget->getPosition().X) <= 1 
-			&& abs(cursor->getPosition().Y - cursorTarget->getPosition().Y) <= 1
-			&& abs(cursor->getSize().X - cursorTarget->getSize().X) <= 1 
-			&& abs(cursor->getSize().Y - cursorTarget->getSize().Y) <= 1
-		) {
-			cursor->setPosition(cursorTarget->getPosition());
-			cursor->setSize(cursorTarget->getSize());
-			cursorTarget = 0;
-		}
+		cursorPosTween.To = cursorTarget->getPosition();
+		cursorSizeTween.To = cursorTarget->getSize();
+		cursor->setPosition(cursorPosTween.valueAt(frameStartTime));
+		cursor->setSize(cursorSizeTween.valueAt(frameStartTime));
+		if(cursorPosTween.isSettled(frameStartTime)) cursorTarget = 0;
 	}
 	
 	//carousel animation
 	if(carouselTargetX != 0) {
-		positionCarousel((carousel[0]->getPosition().X+carouselTargetX*2)/3);
-		if(abs(carousel[0]->getPosition().X - carouselTargetX) <= 1) {
-			positionCarousel(carouselTargetX);
-			carouselTargetX = 0;
-		}
+		positionCarousel(carouselTween.valueAt(frameStartTime).X);
+		if(carouselTween.isSettled(frameStartTime)) carouselTargetX = 0;
 		if(selectionState == MENU_SELECTION_STATE_CAROUSEL) {
 			int pageStartIndex = carouselPage*MENU_MAX_CATALOG_CAROUSEL;
 			int indexInPage = carouselIndex - pageStartIndex;
@@ -830,8 +856,47 @@ void CMenuManager::render()
 	}
 	
 	//draw all
-	time = clock();
-	smgr->drawAll();
+	bool drawn = smgr->drawAll();
+	
+	//frame stats
+	double currTime = mm_getTime();
+	if(drawn) {
+		frameMillis = (currTime - frameStartTime)*1000;
+		frameCount++;
+	}
+	if(currTime - frameCountTime >= 1.0) {
+		framesPerSecond = frameCount / (currTime - frameCountTime);
+		frameCountTime = currTime;
+		frameCount = 0;
+	}
+	
+	//warm up the neighbouring pages once nothing else is going on
+	if(pageState == MENU_PAGE_STATE_CATALOG && carouselPage >= 0 && prefetchPage != carouselPage && isSettled()) prefetchCarouselPages();
+	
+	//hold MENU_FRAME_RATE while anything is changing, otherwise sleep until input or the idle wakeup
+	bool active = drawn || !isSettled();
+	for(int i=INP_BTN_A; i<=INP_BTN_R && !active; i++) active = inp_getButtonState(i) > 0;
+	if(active) {
+		nextFrameTime += 1.0/MENU_FRAME_RATE;
+		if(nextFrameTime < currTime) nextFrameTime = currTime;
+		mm_sleepUntil(nextFrameTime);
+	} else {
+		inp_waitForInput(MENU_IDLE_WAKEUP_MILLIS);
+		nextFrameTime = mm_getTime();
+	}
+}
+
+//! Checks if the cursor and carousel have finished moving and loading
+bool CMenuManager::isSettled()
+{
+	return cursorTarget == 0 && carouselTargetX == 0 && !carouselLoading;
+}
+
+//! Gets the time taken by the last drawn frame and the frames drawn per second
+void CMenuManager::getFrameStats(float* frameMillis, float* framesPerSecond)
+{
+	if(frameMillis) *frameMillis = this->frameMillis;
+	if(framesPerSecond) *framesPerSecond = this->framesPerSecond;
 }
 
 //Util functions
@@ -906,6 +971,8 @@ void CMenuManager::clearPageSpecificNodes()
 	carouselCursor->setLayer(LAYER_HIDDEN);
 	carouselPage = -1;
 	carouselIndex = -1;
+	carouselLoading = false;
+	cancelPrefetch();
 	
 	//Settings Page Scene Nodes
 	stResolutionLabel->setLayer(LAYER_HIDDEN);
@@ -937,63 +1004,43 @@ CSceneNode* CMenuManager::setCarouselIndex(int index, bool updateCursor, bool* n
 		bool hasNext = (pageStartIndex+pageSize < carouselCount);
 		bool hasPrevious = (pageStartIndex-1 >= 0);
 		
-		int height = 400;
+		int height = MENU_CAROUSEL_ART_SIZE;
 		int spacing = 40;
-		int miniHeight = 60;
+		int miniHeight = MENU_MINI_CAROUSEL_ART_SIZE;
 		int miniSpacing = 6;
 		if(smallScreen) {
-			height = 250;
-			miniHeight = 40;
+			height = MENU_CAROUSEL_ART_SIZE_SMALL;
+			miniHeight = MENU_MINI_CAROUSEL_ART_SIZE_SMALL;
 		}
 		
 		//new page?
 		if(carouselPage != page) {
 			
-			//show loading
-			shade->setSize(Vector(vid_getScreenWidth(), vid_getScreenHeight()-(150+90)));
-			shade->setPosition(Vector(0,150));
-			shade->setLayer(9);
-			cursor->setLayer(LAYER_HIDDEN);
-			catGameTitle->setLayer(LAYER_HIDDEN);
-			carouselCursor->setLayer(LAYER_HIDDEN);
-			dpadIcon->setLayer(LAYER_HIDDEN);
-			dpadText->setLayer(LAYER_HIDDEN);
-			abtnIcon->setLayer(LAYER_HIDDEN);
-			abtnText->setLayer(LAYER_HIDDEN);
-			bbtnIcon->setLayer(LAYER_HIDDEN);
-			bbtnText->setLayer(LAYER_HIDDEN);
-			loadingText->setText("Loading...", COLOR_WHITE, COLOR_DARKGRAY, 24, false);
-			loadingText->setPosition(Vector(vid_getScreenWidth()-(loadingText->getSize().X+screenMargin), loadingText->getPosition().Y));
-			loadingText->setLayer(5);
-			this->render();
-			shade->setLayer(LAYER_HIDDEN);
-			
-			//load new images
+			//load new images in the background (placeholders until they arrive)
+			cancelPrefetch();
 			for(int i=0; i<MENU_MAX_CATALOG_CAROUSEL; i++) {
 				if(pageStartIndex+i < carouselCount) {
-					carousel[i]->setImage(carouselArt[pageStartIndex+i], Vector(height,height), true);
-					miniCarousel[i]->setImage(carouselArt[pageStartIndex+i], Vector(miniHeight,miniHeight), true);
+					const char* art = carouselArt[pageStartIndex+i];
+					carousel[i]->requestImage(art, mm_getPlaceholderArt(art), Vector(height,height), miniCarousel[i], Vector(miniHeight,miniHeight), true);
 				} else {
-					carousel[i]->setImage(0, Vector(height,height), true);
-					miniCarousel[i]->setImage(0, Vector(miniHeight,miniHeight), true);
+					carousel[i]->setImage(0, Vector(height,height), miniCarousel[i], Vector(miniHeight,miniHeight), true);
 				}
 			}
 			
 			//next/previous images
 			if(hasNext) {
-				carouselNext->setImageLayered(carouselArt[pageStartIndex+pageSize], "data/img/icon_right_arrow_shadow.png", 190, Vector(height,height), true);
-				miniCarouselNext->setImageLayered(carouselArt[pageStartIndex+pageSize], "data/img/icon_right_arrow_shadow.png", 190, Vector(miniHeight,miniHeight), true);
+				const char* art = carouselArt[pageStartIndex+pageSize];
+				carouselNext->requestImageLayered(art, "data/img/icon_right_arrow_shadow.png", 190, mm_getPlaceholderArt(art), Vector(height,height), miniCarouselNext, Vector(miniHeight,miniHeight), true);
 			} else {
-				carouselNext->setImage(0, Vector(height,height), true);
-				miniCarouselNext->setImage(0, Vector(miniHeight,miniHeight), true);
+				carouselNext->setImage(0, Vector(height,height), miniCarouselNext, Vector(miniHeight,miniHeight), true);
 			}
 			if(hasPrevious) {
-				carouselPrevious->setImageLayered(carouselArt[pageStartIndex-1], "data/img/icon_left_arrow_shadow.png", 190, Vector(height,height), true);
-				miniCarouselPrevious->setImageLayered(carouselArt[pageStartIndex-1], "data/img/icon_left_arrow_shadow.png", 190, Vector(miniHeight,miniHeight), true);
+				const char* art = carouselArt[pageStartIndex-1];
+				carouselPrevious->requestImageLayered(art, "data/img/icon_left_arrow_shadow.png", 190, mm_getPlaceholderArt(art), Vector(height,height), miniCarouselPrevious, Vector(miniHeight,miniHeight), true);
 			} else {
-				carouselPrevious->setImage(0, Vector(height,height), true);
-				miniCarouselPrevious->setImage(0, Vector(miniHeight,miniHeight), true);
+				carouselPrevious->setImage(0, Vector(height,height), miniCarouselPrevious, Vector(miniHeight,miniHeight), true);
 			}
+			carouselLoading = true;
 		}
 		
 		//title
@@ -1079,6 +1126,7 @@ CSceneNode* CMenuManager::setCarouselIndex(int index, bool updateCursor, bool* n
 					if(index > carouselIndex) positionCarousel(carouselOffset + (height+spacing));
 					else positionCarousel(carouselOffset - (height+spacing));
 				}
+				startCarouselAnimation();
 				*noAnimation = true;
 			} else {
 				carouselTargetX = 0;
@@ -1098,10 +1146,10 @@ CSceneNode* CMenuManager::setCarouselIndex(int index, bool updateCursor, bool* n
 }
 void CMenuManager::positionCarousel(int x)
 {
-	int height = 400;
+	int height = MENU_CAROUSEL_ART_SIZE;
 	int spacing = 40;
 	if(smallScreen) {
-		height = 250;
+		height = MENU_CAROUSEL_ART_SIZE_SMALL;
 	}
 	
 	//carousel positions
@@ -1113,6 +1161,51 @@ void CMenuManager::positionCarousel(int x)
 	carouselNext->setPosition(Vector(x+((height+spacing)*MENU_MAX_CATALOG_CAROUSEL), vid_getScreenHeight()/2 - height/2));
 	carouselPrevious->setPosition(Vector(x-(height+spacing), vid_getScreenHeight()/2 - height/2));
 }
+void CMenuManager::startCursorAnimation()
+{
+	cursorPosTween.start(cursor->getPosition(), cursorTarget->getPosition(), mm_getTime(), MENU_CURSOR_ANIMATION_MILLIS/1000.0, EASE_OUT_CUBIC);
+	cursorSizeTween.start(cursor->getSize(), cursorTarget->getSize(), mm_getTime(), MENU_CURSOR_ANIMATION_MILLIS/1000.0, EASE_OUT_CUBIC);
+}
+void CMenuManager::startCarouselAnimation()
+{
+	Vector from(carousel[0]->getPosition().X, 0);
+	carouselTween.start(from, Vector(carouselTargetX, 0), mm_getTime(), MENU_CAROUSEL_ANIMATION_MILLIS/1000.0, EASE_OUT_CUBIC);
+}
+void CMenuManager::updateCarouselImages()
+{
+	carouselLoading = false;
+	for(int i=0; i<MENU_MAX_CATALOG_CAROUSEL; i++) {
+		if(carousel[i]->updateImage()) carouselLoading = true;
+	}
+	if(carouselNext->updateImage()) carouselLoading = true;
+	if(carouselPrevious->updateImage()) carouselLoading = true;
+}
+void CMenuManager::prefetchCarouselPages()
+{
+	int w[2] = { MENU_CAROUSEL_ART_SIZE, MENU_MINI_CAROUSEL_ART_SIZE };
+	if(smallScreen) {
+		w[0] = MENU_CAROUSEL_ART_SIZE_SMALL;
+		w[1] = MENU_MINI_CAROUSEL_ART_SIZE_SMALL;
+	}
+	
+	//previous and next page in the order they would be scrolled to
+	cancelPrefetch();
+	int pages[2] = { carouselPage+1, carouselPage-1 };
+	for(int p=0; p<2; p++) {
+		int pageStartIndex = pages[p]*MENU_MAX_CATALOG_CAROUSEL;
+		for(int i=0; i<MENU_MAX_CATALOG_CAROUSEL && pageStartIndex >= 0 && pageStartIndex+i < carouselCount; i++) {
+			int request = vid_prefetchImageTextures(carouselArt[pageStartIndex+i], 2, w, w, true);
+			if(request) prefetchRequests[prefetchCount++] = request;
+		}
+	}
+	prefetchPage = carouselPage;
+}
+void CMenuManager::cancelPrefetch()
+{
+	for(int i=0; i<prefetchCount; i++) vid_cancelImageTextures(prefetchRequests[i]);
+	prefetchCount = 0;
+	prefetchPage = -1;
+}
 void CMenuManager::updateSettings()
 {
 	int xPadding = 30;
@@ -1156,12 +1249,14 @@ static void* mm_processProgressBar(void* args)
 	int posY = *((int*)params[3]);
 	int sizeX = *((int*)params[4]);
 	int sizeY = *((int*)params[5]);
+	const float* progress = (const float*)params[6];
+	bool* cancel = (bool*)params[7];
 	
-	//loop
+	//loop (runs until ended when real progress is available)
 	int ticks = (duration / MENU_PROGRESS_BAR_UPDATE_MILLIS) + 1;
-	for(int i=0; i<ticks; i++) {
+	for(int i=0; i<ticks || progress; i++) {
 		//sleep a bit before drawing
-		if(ticks > 1) {
+		if(ticks > 1 || progress) {
 			struct timespec ts;
 			ts.tv_sec = MENU_PROGRESS_BAR_UPDATE_MILLIS / 1000;
 			ts.tv_nsec = (MENU_PROGRESS_BAR_UPDATE_MILLIS % 1000) * 1000000;
@@ -1171,11 +1266,46 @@ static void* mm_processProgressBar(void* args)
 		//check for thread end flag
 		if(*endFlag) break;
 		
+		//check for cancel (main loop is blocked while the bar is up)
+		if(cancel) {
+			inp_updateButtonState();
+			if(inp_getButtonState(INP_BTN_B) > 0) *cancel = true;
+		}
+		
 		//draw more progress
 		Color c = COLOR_WHITE;
 		int width = (sizeX*(i+1))/ticks;
+		if(progress) {
+			//transferred bytes lead, the estimate only creeps along during uninterruptible save transfers
+			if(width > (sizeX*9)/10) width = (sizeX*9)/10;
+			int actualWidth = (int)(sizeX*(*progress));
+			if(actualWidth > width) width = actualWidth;
+		}
 		vid_drawBox(posX, posY, width, sizeY, c.Red, c.Green, c.Blue, 255);
 		vid_flush();
 	}
 	return 0;
 }
+
+//Frame timing
+static double mm_getTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec/1000000000.0;
+}
+static void mm_sleepUntil(double time)
+{
+	struct timespec ts;
+	ts.tv_sec = (time_t)time;
+	ts.tv_nsec = (long)((time - ts.tv_sec)*1000000000.0);
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR);
+}
+
+//Carousel art
+static const char* mm_getPlaceholderArt(const char* art)
+{
+	if(strstr(art, "/gba/") || strstr(art, "box_gba")) return mm_placeholderArtGBA;
+	if(strstr(art, "/gbc/") || strstr(art, "box_gbc")) return mm_placeholderArtGBC;
+	return mm_placeholderArtGB;
+}
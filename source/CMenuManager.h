@@ -6,6 +6,8 @@
 #ifndef MENU_MANAGER_H
 #define MENU_MANAGER_H
 
+#include "Tween.h"
+
 #define MENU_PAGE_STATE_NONE 0
 #define MENU_PAGE_STATE_CARTRIDGE 1
 #define MENU_PAGE_STATE_CATALOG 2
@@ -37,8 +39,16 @@
 
 #define MENU_MAX_CATALOG_CAROUSEL 25
 #define MENU_MAX_MODAL_BUTTONS 4
+#define MENU_MAX_PREFETCH (MENU_MAX_CATALOG_CAROUSEL*2)
+#define MENU_CAROUSEL_ART_SIZE 400
+#define MENU_CAROUSEL_ART_SIZE_SMALL 250
+#define MENU_MINI_CAROUSEL_ART_SIZE 60
+#define MENU_MINI_CAROUSEL_ART_SIZE_SMALL 40
 
 #define MENU_FRAME_RATE 30
+#define MENU_IDLE_WAKEUP_MILLIS 100
+#define MENU_CURSOR_ANIMATION_MILLIS 250
+#define MENU_CAROUSEL_ANIMATION_MILLIS 300
 #define MENU_PROGRESS_BAR_UPDATE_MILLIS 500
 
 class CSettingsManager;
@@ -86,8 +96,8 @@ public:
 	//! Displays a modal dialog to the user and returns the selection
 	int showModal(const char* text1, const char* text2, const char** buttonText, const char** buttonDesc, int numButtons);
 	
-	//! Displays the progress bar and starts the async update process
-	void showProgressBar(const char* text, int estimatedDuration);
+	//! Displays the progress bar and starts the async update process (progress and cancel are optional)
+	void showProgressBar(const char* text, int estimatedDuration, const float* progress, bool* cancel);
 	
 	//! Ends the progress bar process and returns menu to previous state
 	void endProgressBar();
@@ -113,10 +123,20 @@ public:
 	//! Renders the menu
 	void render();
 	
+	//! Checks if the cursor and carousel have finished moving and loading
+	bool isSettled();
+	
+	//! Gets the time taken by the last drawn frame and the frames drawn per second
+	void getFrameStats(float* frameMillis, float* framesPerSecond);
+	
 private:
 	CSceneManager* smgr;
 	CSettingsManager* stmgr;
-	long time;
+	double nextFrameTime;
+	double frameCountTime;
+	int frameCount;
+	float frameMillis;
+	float framesPerSecond;
 	int pageState;
 	int selectionState;
 	
@@ -188,13 +208,27 @@ private:
 	//Animation data
 	CSceneNode* cursorTarget;
 	int carouselTargetX;
+	Tween cursorPosTween;
+	Tween cursorSizeTween;
+	Tween carouselTween;
+	bool carouselLoading;
+	int prefetchPage;
+	int prefetchRequests[MENU_MAX_PREFETCH];
+	int prefetchCount;
+	CSceneNode** showProgressBarSceneNodes;
 	unsigned char* showProgressBarSceneNodeLayers;
+	unsigned int showProgressBarSceneNodeCount;
 	bool endProgressBarThread;
 	
 	//Util functions
 	void clearPageSpecificNodes();
 	CSceneNode* setCarouselIndex(int index, bool updateCursor, bool* noAnimation);
 	void positionCarousel(int x);
+	void startCursorAnimation();
+	void startCarouselAnimation();
+	void updateCarouselImages();
+	void prefetchCarouselPages();
+	void cancelPrefetch();
 	void updateSettings();
 };
 
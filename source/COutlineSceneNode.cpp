@@ -16,6 +16,7 @@ COutlineSceneNode::COutlineSceneNode(CSceneManager* smgr)
 void COutlineSceneNode::setColor(Color color)
 {
 	this->color = color;
+	markDirty();
 }
 
 //! Sets the size of the rect
@@ -39,15 +40,5 @@ Vector COutlineSceneNode::getSize() const
 //! Draws the node
 void COutlineSceneNode::render()
 {
-	char width = 4;
-	
-	vid_drawBox(pos.X-width, pos.Y-width, size.X+(width*2), width, color.Red, color.Green, color.Blue, 255);
-	vid_drawBox(pos.X-width, pos.Y+size.Y, size.X+(width*2), width, color.Red, color.Green, color.Blue, 255);
-	vid_drawBox(pos.X-width, pos.Y-width, width, size.Y+(width*2), color.Red, color.Green, color.Blue, 255);
-	vid_drawBox(pos.X+size.X, pos.Y-width, width, size.Y+(width*2), color.Red, color.Green, color.Blue, 255);
-	
-	vid_drawBox(pos.X-(width-1), pos.Y-(width+1), size.X+((width-1)*2), 1, color.Red, color.Green, color.Blue, 255);
-	vid_drawBox(pos.X-(width-1), pos.Y+size.Y+width, size.X+((width-1)*2), 1, color.Red, color.Green, color.Blue, 255);
-	vid_drawBox(pos.X-(width+1), pos.Y-(width-1), 1, size.Y+((width-1)*2), color.Red, color.Green, color.Blue, 255);
-	vid_drawBox(pos.X+size.X+width, pos.Y-(width-1), 1, size.Y+((width-1)*2), color.Red, color.Green, color.Blue, 255);
+	drawFrame(VID_FRAME_OUTLINE, size, color);
 }
@@ -16,18 +16,21 @@ CRectSceneNode::CRectSceneNode(CSceneManager* smgr)
 void CRectSceneNode::setColor(Color color)
 {
 	this->color = color;
+	markDirty();
 }
 
 //! Sets if rect should have a shadow
 void CRectSceneNode::setShadow(bool shadow)
 {
 	this->shadow = shadow;
+	markDirty();
 }
 	
 //! Sets the rect opacity
 void  CRectSceneNode::setOpacity(unsigned char opacity)
 {
 	this->opacity = opacity;
+	markDirty();
 }
 
 //! Sets the size of the rect
@@ -65,16 +68,6 @@ void CRectSceneNode::render()
 {
 	vid_drawBox(pos.X, pos.Y, size.X, size.Y, color.Red, color.Green, color.Blue, opacity);
 	if(shadow) {
-		Color falloff1 = Color(30,30,30);
-		vid_drawBox(pos.X-1, pos.Y-1, size.X+2, 1, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X-1, pos.Y+size.Y, size.X+2, 1, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X-1, pos.Y-1, 1, size.Y+2, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X+size.X, pos.Y-1, 1, size.Y+2, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		
-		Color falloff2 = Color(40,40,40);
-		vid_drawBox(pos.X, pos.Y-2, size.X, 1, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X, pos.Y+size.Y+1, size.X, 1, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X-2, pos.Y, 1, size.Y, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X+size.X+1, pos.Y, 1, size.Y, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
+		drawFrame(VID_FRAME_SHADOW, size, Color(0,0,0));
 	}
 }
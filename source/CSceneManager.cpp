@@ -12,8 +12,12 @@
 
 //! Main constructor
 CSceneManager::CSceneManager()
-	: nodeListSize(0)
+	: nodeListSize(0), nodeOrder(0), dirtyRectCount(0)
 {
+	for(int i=0; i<NUM_LAYERS; i++) {
+		layerHeads[i] = 0;
+		layerTails[i] = 0;
+	}
 }
 
 //! Destructor
@@ -34,11 +38,7 @@ CRectSceneNode* CSceneManager::addRectSceneNode(Color color, Vector size, bool s
 	node->setShadow(shadow);
 
 	//add node to the list
-	if(nodeListSize+1 < MAX_NUM_NODES)
-	{
-		nodeList[nodeListSize] = node;
-		nodeListSize++;
-	}
+	addNode(node);
 
 	//return 
 	return node;
@@ -54,11 +54,7 @@ COutlineSceneNode* CSceneManager::addOutlineSceneNode(Color color, Vector size)
 	node->setSize(size);
 
 	//add node to the list
-	if(nodeListSize+1 < MAX_NUM_NODES)
-	{
-		nodeList[nodeListSize] = node;
-		nodeListSize++;
-	}
+	addNode(node);
 
 	//return 
 	return node;
@@ -74,11 +70,7 @@ CImageSceneNode* CSceneManager::addImageSceneNode(const char* filename, Vector s
 	node->setShadow(shadow);
 
 	//add node to the list
-	if(nodeListSize+1 < MAX_NUM_NODES)
-	{
-		nodeList[nodeListSize] = node;
-		nodeListSize++;
-	}
+	addNode(node);
 
 	//return 
 	return node;
@@ -93,11 +85,7 @@ CTextSceneNode* CSceneManager::addTextSceneNode(const char* text, Color textColo
 	node->setText(text, textColor, backgroundColor, fontSize, bold);
 
 	//add node to the list
-	if(nodeListSize+1 < MAX_NUM_NODES)
-	{
-		nodeList[nodeListSize] = node;
-		nodeListSize++;
-	}
+	addNode(node);
 
 	//return 
 	return node;
@@ -129,6 +117,8 @@ void CSceneManager::removeNode(CSceneNode* node)
 
 			//sucessfully removed
 			nodeListSize--;
+			unlinkNode(node);
+			node->order = 0;
 			
 			//clear the nodes memory
 			delete node;
@@ -151,27 +141,178 @@ void CSceneManager::clearScene()
 	nodeListSize = 0;
 }
 
-//! Draws the scene
-void CSceneManager::drawAll()
+//! Records the layer of every visible node (returns the number recorded, at most max)
+unsigned int CSceneManager::saveLayers(CSceneNode** nodes, unsigned char* layers, unsigned int max)
+{
+	unsigned int count = 0;
+	for(int layer=1; layer<NUM_LAYERS; layer++) {
+		for(CSceneNode* node=layerHeads[layer]; node && count<max; node=node->layerNext) {
+			nodes[count] = node;
+			layers[count] = layer;
+			count++;
+		}
+	}
+	return count;
+}
+
+//! Hides every node then puts back the layers recorded by saveLayers
+void CSceneManager::restoreLayers(CSceneNode** nodes, unsigned char* layers, unsigned int count)
+{
+	hideAll();
+	for(unsigned int i=0; i<count; i++) nodes[i]->setLayer(layers[i]);
+}
+
+//! Hides every visible node
+void CSceneManager::hideAll()
+{
+	for(int layer=1; layer<NUM_LAYERS; layer++) {
+		while(layerHeads[layer]) moveNode(layerHeads[layer], LAYER_HIDDEN);
+	}
+}
+
+//! Marks the whole screen to be redrawn on the next draw
+void CSceneManager::invalidate()
 {
-	//find max layer
-	unsigned char maxLayer = 0;
-	for(int i=0; i<nodeListSize; i++) {
-		if(nodeList[i]->getLayer() > maxLayer) maxLayer = nodeList[i]->getLayer();
+	dirtyRectCount = 0;
+	addDirtyRect(Vector(0,0), Vector(vid_getScreenWidth(), vid_getScreenHeight()));
+}
+
+//! Draws the parts of the scene that changed since the last draw (returns false if nothing changed)
+bool CSceneManager::drawAll()
+{
+	//damage is where visible nodes were and are now for any that moved, resized or changed content
+	//(hidden and removed nodes already added their old rects when they left their layer list)
+	for(int layer=1; layer<NUM_LAYERS; layer++) {
+		for(CSceneNode* node=layerHeads[layer]; node; node=node->layerNext) {
+			Vector pos = node->getPosition() - Vector(DIRTY_MARGIN,DIRTY_MARGIN);
+			Vector size = node->getSize() + Vector(DIRTY_MARGIN*2,DIRTY_MARGIN*2);
+			if(node->dirty || pos != node->drawnPos || size != node->drawnSize) {
+				addDirtyRect(node->drawnPos, node->drawnSize);
+				addDirtyRect(pos, size);
+				node->drawnPos = pos;
+				node->drawnSize = size;
+				node->dirty = false;
+			}
+		}
 	}
 	
-	//draw each node in layer order
-	for(int layer=1; layer<maxLayer+1; layer++)
-		for(int i=0; i<nodeListSize; i++)
-			if(nodeList[i]->getLayer() == layer) nodeList[i]->render();
-		
-	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	//vid_shadeBox(0, 335, 1920, 550, 0,0,0);
+	//nothing changed
+	if(dirtyRectCount == 0) return false;
 	
-	//set render box?
-	//draw shade once
-	//speed up rendering by combining textures?
+	//redraw each damaged rect with the nodes that touch it in layer order
+	for(int r=0; r<dirtyRectCount; r++) {
+		int* rect = dirtyRects[r];
+		vid_setClip(rect[0], rect[1], rect[2], rect[3]);
+		for(int layer=1; layer<NUM_LAYERS; layer++) {
+			for(CSceneNode* node=layerHeads[layer]; node; node=node->layerNext) {
+				if(node->drawnPos.X >= rect[0]+rect[2] || node->drawnPos.X+node->drawnSize.X <= rect[0]) continue;
+				if(node->drawnPos.Y >= rect[1]+rect[3] || node->drawnPos.Y+node->drawnSize.Y <= rect[1]) continue;
+				node->render();
+			}
+		}
+	}
+	vid_clearClip();
+	
+	//push only the damaged parts to screen
+	vid_flushRects((int*)dirtyRects, dirtyRectCount);
+	dirtyRectCount = 0;
+	return true;
+}
+
+//! Adds a rect to be redrawn, merging it with any it overlaps
+void CSceneManager::addDirtyRect(Vector pos, Vector size)
+{
+	//keep to the screen
+	int x1 = pos.X < 0 ? 0 : pos.X;
+	int y1 = pos.Y < 0 ? 0 : pos.Y;
+	int x2 = pos.X+size.X > vid_getScreenWidth() ? vid_getScreenWidth() : pos.X+size.X;
+	int y2 = pos.Y+size.Y > vid_getScreenHeight() ? vid_getScreenHeight() : pos.Y+size.Y;
+	if(x2 <= x1 || y2 <= y1) return;
+	
+	//grow into any overlapping rects (which may in turn overlap others)
+	bool merged = true;
+	while(merged) {
+		merged = false;
+		for(int i=0; i<dirtyRectCount; i++) {
+			int* rect = dirtyRects[i];
+			if(x1 > rect[0]+rect[2] || x2 < rect[0] || y1 > rect[1]+rect[3] || y2 < rect[1]) continue;
+			if(rect[0] < x1) x1 = rect[0];
+			if(rect[1] < y1) y1 = rect[1];
+			if(rect[0]+rect[2] > x2) x2 = rect[0]+rect[2];
+			if(rect[1]+rect[3] > y2) y2 = rect[1]+rect[3];
+			dirtyRectCount--;
+			for(int j=0; j<4; j++) rect[j] = dirtyRects[dirtyRectCount][j];
+			merged = true;
+			break;
+		}
+	}
+	
+	//too many separate rects, fall back to one covering them all
+	if(dirtyRectCount == MAX_DIRTY_RECTS) {
+		for(int i=0; i<dirtyRectCount; i++) {
+			int* rect = dirtyRects[i];
+			if(rect[0] < x1) x1 = rect[0];
+			if(rect[1] < y1) y1 = rect[1];
+			if(rect[0]+rect[2] > x2) x2 = rect[0]+rect[2];
+			if(rect[1]+rect[3] > y2) y2 = rect[1]+rect[3];
+		}
+		dirtyRectCount = 0;
+	}
+	dirtyRects[dirtyRectCount][0] = x1;
+	dirtyRects[dirtyRectCount][1] = y1;
+	dirtyRects[dirtyRectCount][2] = x2 - x1;
+	dirtyRects[dirtyRectCount][3] = y2 - y1;
+	dirtyRectCount++;
+}
+
+//! Adds a node to the list, giving it its place in draw order
+void CSceneManager::addNode(CSceneNode* node)
+{
+	if(nodeListSize+1 < MAX_NUM_NODES)
+	{
+		nodeList[nodeListSize] = node;
+		nodeListSize++;
+		node->order = ++nodeOrder;
+	}
+}
+
+//! Moves a node to the list of the given layer, keeping each layer in order of creation
+void CSceneManager::moveNode(CSceneNode* node, unsigned char layer)
+{
+	//nodes not in the scene are never drawn
+	if(node->order == 0) {
+		node->layer = layer;
+		return;
+	}
+	unlinkNode(node);
+	node->layer = layer;
+	if(layer == LAYER_HIDDEN) return;
+	
+	//nodes are mostly created in the order they are shown so search from the back
+	CSceneNode* prev = layerTails[layer];
+	while(prev && prev->order > node->order) prev = prev->layerPrev;
+	node->layerPrev = prev;
+	node->layerNext = prev ? prev->layerNext : layerHeads[layer];
+	if(node->layerNext) node->layerNext->layerPrev = node;
+	else layerTails[layer] = node;
+	if(prev) prev->layerNext = node;
+	else layerHeads[layer] = node;
+	node->dirty = true;
+}
+
+//! Takes a node out of its layer list, damaging where it was last drawn
+void CSceneManager::unlinkNode(CSceneNode* node)
+{
+	if(node->layer == LAYER_HIDDEN) return;
+	if(node->layerPrev) node->layerPrev->layerNext = node->layerNext;
+	else layerHeads[node->layer] = node->layerNext;
+	if(node->layerNext) node->layerNext->layerPrev = node->layerPrev;
+	else layerTails[node->layer] = node->layerPrev;
+	node->layerPrev = 0;
+	node->layerNext = 0;
 	
-	//push to screen
-	vid_flush();
+	//nothing is drawn there anymore
+	addDirtyRect(node->drawnPos, node->drawnSize);
+	node->drawnPos = Vector(0,0);
+	node->drawnSize = Vector(0,0);
 }
@@ -10,8 +10,11 @@
 #include "Vector.h"
 
 #define MAX_NUM_NODES 512
+#define MAX_DIRTY_RECTS 32
+#define DIRTY_MARGIN 6
 
 #define LAYER_HIDDEN 0
+#define NUM_LAYERS 256
 
 class CSceneNode;
 class CRectSceneNode;
@@ -53,12 +56,36 @@ public:
 	//! Clears all nodes from the scene
 	void clearScene();
 
-	//! Draws the scene
-	void drawAll();
+	//! Records the layer of every visible node (returns the number recorded, at most max)
+	unsigned int saveLayers(CSceneNode** nodes, unsigned char* layers, unsigned int max);
+
+	//! Hides every node then puts back the layers recorded by saveLayers
+	void restoreLayers(CSceneNode** nodes, unsigned char* layers, unsigned int count);
+
+	//! Hides every visible node
+	void hideAll();
+
+	//! Marks the whole screen to be redrawn on the next draw
+	void invalidate();
+
+	//! Draws the parts of the scene that changed since the last draw (returns false if nothing changed)
+	bool drawAll();
 	
 private:
+	friend class CSceneNode;
 	CSceneNode* nodeList[MAX_NUM_NODES];
 	unsigned int nodeListSize;
+	unsigned int nodeOrder;
+	CSceneNode* layerHeads[NUM_LAYERS];
+	CSceneNode* layerTails[NUM_LAYERS];
+	int dirtyRects[MAX_DIRTY_RECTS][4];
+	int dirtyRectCount;
+	
+	//Util functions
+	void addDirtyRect(Vector pos, Vector size);
+	void addNode(CSceneNode* node);
+	void moveNode(CSceneNode* node, unsigned char layer);
+	void unlinkNode(CSceneNode* node);
 };
 
 #endif
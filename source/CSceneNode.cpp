@@ -8,7 +8,7 @@
 
 //! Main Constructor
 CSceneNode::CSceneNode(CSceneManager* smgr)
-	: pos(0,0), layer(LAYER_HIDDEN), navPath(-1), navAText(0), navBText(0), sceneManager(smgr)
+	: pos(0,0), layer(LAYER_HIDDEN), navPath(-1), navAText(0), navBText(0), sceneManager(smgr), dirty(true), drawnPos(0,0), drawnSize(0,0), order(0), layerPrev(0), layerNext(0), frameImg(0), frameSize(0,0), frameColor(0,0,0)
 {
 }
 
@@ -16,6 +16,7 @@ CSceneNode::CSceneNode(CSceneManager* smgr)
 CSceneNode::~CSceneNode()
 {
 	remove();
+	vid_clearTexture(frameImg);
 }
 
 //! Draws the node
@@ -38,7 +39,7 @@ void CSceneNode::setPosition(Vector pos)
 //! Sets the rendering layer of the node
 void CSceneNode::setLayer(unsigned char layer)
 {
-	this->layer = layer;
+	if(this->layer != layer) sceneManager->moveNode(this, layer);
 }
 
 //! Sets the navigation flag for the node
@@ -94,3 +95,28 @@ const char* CSceneNode::getNavBText() const
 {
 	return navBText;
 }
+
+//! Flags the node to be redrawn on the next draw
+void CSceneNode::markDirty()
+{
+	dirty = true;
+}
+
+//! Draws a shadow or outline frame around the node
+void CSceneNode::drawFrame(char style, Vector size, Color color)
+{
+	//draw the lines directly while the size or color is animating, then bake them once it settles
+	if(size != frameSize || color != frameColor || !frameImg) {
+		bool settled = (size == frameSize && color == frameColor);
+		frameSize = size;
+		frameColor = color;
+		vid_clearTexture(frameImg);
+		frameImg = settled ? vid_generateFrameTexture(style, size.X, size.Y, color.Red, color.Green, color.Blue) : 0;
+		if(!frameImg) {
+			vid_drawFrame(style, pos.X, pos.Y, size.X, size.Y, color.Red, color.Green, color.Blue);
+			return;
+		}
+	}
+	int border = (style == VID_FRAME_OUTLINE) ? VID_FRAME_OUTLINE_BORDER : VID_FRAME_SHADOW_BORDER;
+	vid_drawTexture(frameImg, pos.X-border, pos.Y-border);
+}
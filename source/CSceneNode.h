@@ -6,7 +6,9 @@
 #ifndef SCENE_NODE_H
 #define SCENE_NODE_H
 
+#include "Color.h"
 #include "Vector.h"
+#include <vid.h>
 
 class CSceneManager;
 
@@ -59,6 +61,9 @@ public:
 	//! Gets the navigation b text for the node
 	virtual const char* getNavBText() const;
 	
+	//! Flags the node to be redrawn on the next draw
+	void markDirty();
+	
 protected:
 	Vector pos;
 	unsigned char layer;
@@ -66,6 +71,21 @@ protected:
 	const char* navAText;
 	const char* navBText;
 	CSceneManager* sceneManager;
+	
+	//! Draws a shadow or outline frame around the node
+	void drawFrame(char style, Vector size, Color color);
+	
+private:
+	friend class CSceneManager;
+	bool dirty;
+	Vector drawnPos;
+	Vector drawnSize;
+	unsigned int order;
+	CSceneNode* layerPrev;
+	CSceneNode* layerNext;
+	VidTexture* frameImg;
+	Vector frameSize;
+	Color frameColor;
 };
 
 #endif
@@ -26,6 +26,7 @@ void CTextSceneNode::setText(const char* text, Color textColor, Color background
 	if(txt==0 || text==0 || strcmp(text, txt)!=0) {
 		
 		//clear old data
+		markDirty();
 		vid_clearTexture(img);
 		img = 0;
 		delete[] txt;
@@ -45,6 +46,7 @@ void CTextSceneNode::setText(const char* text, Color textColor, Color background
 void CTextSceneNode::setShadow(bool shadow)
 {
 	this->shadow = shadow;
+	markDirty();
 }
 	
 //! Gets the text
@@ -72,16 +74,6 @@ void CTextSceneNode::render()
 	if(img) vid_drawTexture(img, pos.X, pos.Y);
 	if(shadow) {
 		Vector size = getSize();
-		Color falloff1 = Color(30,30,30);
-		vid_drawBox(pos.X-1, pos.Y-1, size.X+2, 1, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X-1, pos.Y+size.Y, size.X+2, 1, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X-1, pos.Y-1, 1, size.Y+2, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		vid_drawBox(pos.X+size.X, pos.Y-1, 1, size.Y+2, falloff1.Red, falloff1.Green, falloff1.Blue, 255);
-		
-		Color falloff2 = Color(40,40,40);
-		vid_drawBox(pos.X, pos.Y-2, size.X, 1, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X, pos.Y+size.Y+1, size.X, 1, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X-2, pos.Y, 1, size.Y, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
-		vid_drawBox(pos.X+size.X+1, pos.Y, 1, size.Y, falloff2.Red, falloff2.Green, falloff2.Blue, 255);
+		drawFrame(VID_FRAME_SHADOW, size, Color(0,0,0));
 	}
 }
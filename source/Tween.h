@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------------------
+// Title:	Tween
+// Program: GameBoy Console
+// Authors: Stephen Monn
+//-----------------------------------------------------------------------------------------
+#ifndef TWEEN_H
+#define TWEEN_H
+
+#include "Vector.h"
+
+// Easing Curves
+#define EASE_LINEAR 0
+#define EASE_OUT_QUAD 1
+#define EASE_OUT_CUBIC 2
+#define EASE_IN_OUT_CUBIC 3
+
+//! Class that moves a Vector towards a target over time
+class Tween
+{
+public:
+	//! Default constructor
+	Tween() : From(0,0), To(0,0), StartTime(0), Duration(0), Ease(EASE_LINEAR) {}
+
+	//! Starts moving from the given value to the target (times are in seconds)
+	void start(const Vector& from, const Vector& to, double time, double duration, char ease) {
+		From = from;
+		To = to;
+		StartTime = time;
+		Duration = duration;
+		Ease = ease;
+	}
+
+	//! Gets the value at the given time
+	Vector valueAt(double time) const {
+		if(isSettled(time)) return To;
+		double t = ease(Ease, (time - StartTime) / Duration);
+		if(t < 0) t = 0;
+		return Vector(From.X + (int)((To.X - From.X)*t), From.Y + (int)((To.Y - From.Y)*t));
+	}
+
+	//! Checks if the target has been reached by the given time
+	bool isSettled(double time) const {
+		return Duration <= 0 || time >= StartTime + Duration;
+	}
+
+	//! Applies the given easing curve to a progress value from 0 to 1
+	static double ease(char type, double t) {
+		if(type == EASE_OUT_QUAD) return 1 - (1-t)*(1-t);
+		if(type == EASE_OUT_CUBIC) return 1 - (1-t)*(1-t)*(1-t);
+		if(type == EASE_IN_OUT_CUBIC) {
+			if(t < 0.5) return 4*t*t*t;
+			return 1 - ((2-2*t)*(2-2*t)*(2-2*t))/2;
+		}
+		return t;
+	}
+
+	//! Start value
+	Vector From;
+
+	//! Target value
+	Vector To;
+
+	//! Time the tween started
+	double StartTime;
+
+	//! Time taken to reach the target
+	double Duration;
+
+	//! Easing curve
+	char Ease;
+};
+
+#endif
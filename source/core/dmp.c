@@ -0,0 +1,402 @@
+#include "dmp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/sha.h>
+
+#define DMP_VERSION 1
+#define DMP_HEADER_SIZE 128
+#define DMP_ENTRY_SIZE 28
+
+typedef struct {
+	FILE* file;
+	dmp_header header;
+	unsigned int romBlocks;
+	unsigned int saveBlocks;
+	unsigned int romWritten;
+	unsigned int saveWritten;
+	unsigned char* table;
+} dmp_writerData;
+
+typedef struct {
+	FILE* file;
+	dmp_header header;
+	unsigned int tableOffset;
+	char* block;
+} dmp_readerData;
+
+// Constants
+static const char* dmp_magic = "GBXDUMP1";
+
+// Data
+static unsigned int dmp_crcTable[256];
+static char dmp_crcTableInit = 0;
+
+// Helper functions
+static int dmp_writeBlock(dmp_writerData* writerData, char section, char* data, unsigned int length, unsigned char retries);
+static FILE* dmp_open(const char* filename, dmp_header* header, unsigned int* tableOffset);
+static int dmp_checkBlock(FILE* file, dmp_header* header, unsigned int tableOffset, char section, unsigned int index, char* data, unsigned char* retries);
+static void dmp_encodeHeader(unsigned char* buffer, dmp_header* header, unsigned int tableOffset);
+static int dmp_decodeHeader(unsigned char* buffer, dmp_header* header, unsigned int* tableOffset);
+static void dmp_encodeEntry(unsigned char* entry, char* data, unsigned int length, unsigned char retries);
+
+// Util functions
+static unsigned int dmp_numBlocks(unsigned int size);
+static unsigned int dmp_blockLength(unsigned int size, unsigned int index);
+static unsigned int dmp_crc32(char* data, unsigned int length);
+static void dmp_putInt(unsigned char* buffer, unsigned int value);
+static unsigned int dmp_getInt(unsigned char* buffer);
+
+// Creates a dump container and writes its header (null on failure)
+dmp_writer* dmp_create(const char* filename, dmp_header* header)
+{
+	FILE* file = fopen(filename, "wb");
+	if(file == NULL) return 0;
+	
+	//header goes out first without a table offset so unfinished containers can be told apart
+	unsigned char buffer[DMP_HEADER_SIZE];
+	dmp_encodeHeader(buffer, header, 0);
+	if(fwrite(buffer, DMP_HEADER_SIZE, 1, file) != 1) {
+		fclose(file);
+		return 0;
+	}
+	
+	dmp_writerData* writerData = (dmp_writerData*)malloc(sizeof(dmp_writerData));
+	if(writerData == 0) {
+		fclose(file);
+		return 0;
+	}
+	writerData->file = file;
+	writerData->header = *header;
+	writerData->romBlocks = dmp_numBlocks(header->romSize);
+	writerData->saveBlocks = dmp_numBlocks(header->saveSize);
+	writerData->romWritten = 0;
+	writerData->saveWritten = 0;
+	writerData->table = (unsigned char*)calloc(writerData->romBlocks + writerData->saveBlocks + 1, DMP_ENTRY_SIZE);
+	if(writerData->table == 0) {
+		fclose(file);
+		free(writerData);
+		return 0;
+	}
+	return (dmp_writer*)writerData;
+}
+
+// Appends the next ROM block along with the number of retries it took to read
+int dmp_writeROMBlock(dmp_writer* writer, char* data, unsigned int length, unsigned char retries)
+{
+	return dmp_writeBlock((dmp_writerData*)writer, DMP_SECTION_ROM, data, length, retries);
+}
+
+// Appends the next Save block along with the number of retries it took to read (after all ROM blocks)
+int dmp_writeSaveBlock(dmp_writer* writer, char* data, unsigned int length, unsigned char retries)
+{
+	return dmp_writeBlock((dmp_writerData*)writer, DMP_SECTION_SAVE, data, length, retries);
+}
+
+// Writes the block tables and closes the dump container (returns 0 if all blocks were written)
+int dmp_close(dmp_writer* writer)
+{
+	dmp_writerData* writerData = (dmp_writerData*)writer;
+	if(writerData == 0) return DMP_ERROR_FILE;
+	
+	int result = 0;
+	if(writerData->romWritten < writerData->romBlocks || writerData->saveWritten < writerData->saveBlocks) {
+		result = DMP_ERROR_SIZE;
+	} else {
+		//tables follow the data, then the header is rewritten to point at them
+		unsigned int tableOffset = DMP_HEADER_SIZE + writerData->header.romSize + writerData->header.saveSize;
+		unsigned int tableSize = (writerData->romBlocks + writerData->saveBlocks) * DMP_ENTRY_SIZE;
+		unsigned char buffer[DMP_HEADER_SIZE];
+		dmp_encodeHeader(buffer, &writerData->header, tableOffset);
+		if(tableSize > 0 && fwrite(writerData->table, tableSize, 1, writerData->file) != 1) result = DMP_ERROR_FILE;
+		else if(fseek(writerData->file, 0, SEEK_SET) != 0 || fwrite(buffer, DMP_HEADER_SIZE, 1, writerData->file) != 1) result = DMP_ERROR_FILE;
+	}
+	
+	if(fclose(writerData->file) != 0 && result == 0) result = DMP_ERROR_FILE;
+	free(writerData->table);
+	free(writerData);
+	return result;
+}
+
+// Reads the header of a dump container
+int dmp_readHeader(const char* filename, dmp_header* header)
+{
+	unsigned int tableOffset = 0;
+	FILE* file = dmp_open(filename, header, &tableOffset);
+	if(file == NULL) return DMP_ERROR_FORMAT;
+	
+	fclose(file);
+	return 0;
+}
+
+// Reads and checks a single block of a dump container (returns the block length, data is only written if the block checks out)
+int dmp_readBlock(const char* filename, char section, unsigned int index, char* data, unsigned char* retries)
+{
+	dmp_header header;
+	dmp_reader* reader = dmp_openReader(filename, &header);
+	if(reader == 0) return DMP_ERROR_FORMAT;
+	
+	int result = dmp_readBlockFrom(reader, section, index, data, retries);
+	dmp_closeReader(reader);
+	return result;
+}
+
+// Opens a dump container for reading several blocks (null on failure)
+dmp_reader* dmp_openReader(const char* filename, dmp_header* header)
+{
+	dmp_readerData* readerData = (dmp_readerData*)malloc(sizeof(dmp_readerData));
+	if(readerData == 0) return 0;
+	readerData->tableOffset = 0;
+	readerData->file = dmp_open(filename, &readerData->header, &readerData->tableOffset);
+	readerData->block = (char*)malloc(DMP_BLOCK_SIZE);
+	if(readerData->file == NULL || readerData->block == 0) {
+		if(readerData->file) fclose(readerData->file);
+		free(readerData->block);
+		free(readerData);
+		return 0;
+	}
+	
+	if(header) *header = readerData->header;
+	return (dmp_reader*)readerData;
+}
+
+// Reads and checks a single block of an open dump container (returns the block length, data is only written if the block checks out)
+int dmp_readBlockFrom(dmp_reader* reader, char section, unsigned int index, char* data, unsigned char* retries)
+{
+	dmp_readerData* readerData = (dmp_readerData*)reader;
+	
+	//blocks are checked in scratch space so a corrupt block never touches the caller's data
+	int result = dmp_checkBlock(readerData->file, &readerData->header, readerData->tableOffset, section, index, readerData->block, retries);
+	if(result > 0) memcpy(data, readerData->block, result);
+	return result;
+}
+
+// Closes a dump container opened for reading
+void dmp_closeReader(dmp_reader* reader)
+{
+	dmp_readerData* readerData = (dmp_readerData*)reader;
+	fclose(readerData->file);
+	free(readerData->block);
+	free(readerData);
+}
+
+// Checks every block of a dump container against its hashes (returns the number of bad blocks)
+int dmp_verify(const char* filename)
+{
+	dmp_header header;
+	unsigned int tableOffset = 0;
+	FILE* file = dmp_open(filename, &header, &tableOffset);
+	if(file == NULL) return DMP_ERROR_FORMAT;
+	
+	unsigned int i;
+	int badBlocks = 0;
+	char* data = (char*)malloc(DMP_BLOCK_SIZE);
+	if(data == 0) {
+		fclose(file);
+		return DMP_ERROR_FILE;
+	}
+	for(i=0; i<dmp_numBlocks(header.romSize); i++) {
+		if(dmp_checkBlock(file, &header, tableOffset, DMP_SECTION_ROM, i, data, 0) < 0) badBlocks++;
+	}
+	for(i=0; i<dmp_numBlocks(header.saveSize); i++) {
+		if(dmp_checkBlock(file, &header, tableOffset, DMP_SECTION_SAVE, i, data, 0) < 0) badBlocks++;
+	}
+	
+	free(data);
+	fclose(file);
+	return badBlocks;
+}
+
+// Exports a dump container back to plain ROM and Save files (either filename can be null)
+int dmp_export(const char* filename, const char* romFilename, const char* saveFilename)
+{
+	dmp_header header;
+	unsigned int tableOffset = 0;
+	FILE* file = dmp_open(filename, &header, &tableOffset);
+	if(file == NULL) return DMP_ERROR_FORMAT;
+	
+	int result = 0;
+	char* data = (char*)malloc(DMP_BLOCK_SIZE);
+	if(data == 0) {
+		fclose(file);
+		return DMP_ERROR_FILE;
+	}
+	for(char section=DMP_SECTION_ROM; section<=DMP_SECTION_SAVE && result == 0; section++) {
+		const char* outFilename = (section == DMP_SECTION_ROM) ? romFilename : saveFilename;
+		unsigned int size = (section == DMP_SECTION_ROM) ? header.romSize : header.saveSize;
+		if(outFilename == 0 || size == 0) continue;
+		
+		FILE* outFile = fopen(outFilename, "wb");
+		if(outFile == NULL) {
+			result = DMP_ERROR_FILE;
+			break;
+		}
+		
+		//every block is checked on the way out so a bad container never produces a bad file
+		unsigned int i;
+		for(i=0; i<dmp_numBlocks(size); i++) {
+			int length = dmp_checkBlock(file, &header, tableOffset, section, i, data, 0);
+			if(length < 0) {
+				result = length;
+				break;
+			}
+			if(fwrite(data, length, 1, outFile) != 1) {
+				result = DMP_ERROR_FILE;
+				break;
+			}
+		}
+		if(fclose(outFile) != 0 && result == 0) result = DMP_ERROR_FILE;
+		if(result != 0) remove(outFilename);
+	}
+	
+	free(data);
+	fclose(file);
+	return result;
+}
+
+// Writes a block to the container and records its hashes
+static int dmp_writeBlock(dmp_writerData* writerData, char section, char* data, unsigned int length, unsigned char retries) {
+	if(writerData == 0) return DMP_ERROR_FILE;
+	
+	//blocks must arrive in order with the expected lengths
+	unsigned int index, entry;
+	if(section == DMP_SECTION_ROM) {
+		index = writerData->romWritten;
+		entry = index;
+		if(index >= writerData->romBlocks || length != dmp_blockLength(writerData->header.romSize, index)) return DMP_ERROR_SIZE;
+	} else {
+		index = writerData->saveWritten;
+		entry = writerData->romBlocks + index;
+		if(writerData->romWritten < writerData->romBlocks) return DMP_ERROR_SIZE;
+		if(index >= writerData->saveBlocks || length != dmp_blockLength(writerData->header.saveSize, index)) return DMP_ERROR_SIZE;
+	}
+	if(fwrite(data, length, 1, writerData->file) != 1) return DMP_ERROR_FILE;
+	
+	dmp_encodeEntry(writerData->table + (entry * DMP_ENTRY_SIZE), data, length, retries);
+	if(section == DMP_SECTION_ROM) writerData->romWritten++;
+	else writerData->saveWritten++;
+	return length;
+}
+
+// Opens a finished dump container and reads its header
+static FILE* dmp_open(const char* filename, dmp_header* header, unsigned int* tableOffset) {
+	FILE* file = fopen(filename, "rb");
+	if(file == NULL) return NULL;
+	
+	unsigned char buffer[DMP_HEADER_SIZE];
+	if(fread(buffer, DMP_HEADER_SIZE, 1, file) != 1 || dmp_decodeHeader(buffer, header, tableOffset) != 0) {
+		fclose(file);
+		return NULL;
+	}
+	return file;
+}
+
+// Reads a block and checks it against its table entry (returns the block length)
+static int dmp_checkBlock(FILE* file, dmp_header* header, unsigned int tableOffset, char section, unsigned int index, char* data, unsigned char* retries) {
+	unsigned int offset = DMP_HEADER_SIZE;
+	unsigned int entry = index;
+	unsigned int size = header->romSize;
+	if(section == DMP_SECTION_SAVE) {
+		offset += header->romSize;
+		entry += dmp_numBlocks(header->romSize);
+		size = header->saveSize;
+	}
+	if(index >= dmp_numBlocks(size)) return DMP_ERROR_SIZE;
+	
+	//read block data and its entry
+	unsigned int length = dmp_blockLength(size, index);
+	unsigned char stored[DMP_ENTRY_SIZE];
+	if(fseek(file, offset + (index * DMP_BLOCK_SIZE), SEEK_SET) != 0 || fread(data, length, 1, file) != 1) return DMP_ERROR_FILE;
+	if(fseek(file, tableOffset + (entry * DMP_ENTRY_SIZE), SEEK_SET) != 0 || fread(stored, DMP_ENTRY_SIZE, 1, file) != 1) return DMP_ERROR_FILE;
+	if(retries) *retries = stored[24];
+	
+	//compare against freshly computed hashes (retry count isn't part of the check)
+	unsigned char computed[DMP_ENTRY_SIZE];
+	dmp_encodeEntry(computed, data, length, stored[24]);
+	if(memcmp(stored, computed, DMP_ENTRY_SIZE) != 0) return DMP_ERROR_CORRUPT;
+	return length;
+}
+
+// Encodes the header block (little endian)
+static void dmp_encodeHeader(unsigned char* buffer, dmp_header* header, unsigned int tableOffset) {
+	memset(buffer, 0, DMP_HEADER_SIZE);
+	memcpy(buffer, dmp_magic, 8);
+	dmp_putInt(buffer + 8, DMP_VERSION);
+	buffer[12] = header->cartridgeType;
+	buffer[13] = header->memoryType;
+	strncpy((char*)buffer + 16, header->title, 31);
+	strncpy((char*)buffer + 48, header->identifier, 47);
+	dmp_putInt(buffer + 96, header->romSize);
+	dmp_putInt(buffer + 100, header->saveSize);
+	dmp_putInt(buffer + 104, DMP_BLOCK_SIZE);
+	dmp_putInt(buffer + 108, dmp_numBlocks(header->romSize));
+	dmp_putInt(buffer + 112, dmp_numBlocks(header->saveSize));
+	dmp_putInt(buffer + 116, tableOffset);
+}
+
+// Decodes the header block (only finished containers are accepted)
+static int dmp_decodeHeader(unsigned char* buffer, dmp_header* header, unsigned int* tableOffset) {
+	if(memcmp(buffer, dmp_magic, 8) != 0 || dmp_getInt(buffer + 8) != DMP_VERSION) return DMP_ERROR_FORMAT;
+	if(dmp_getInt(buffer + 104) != DMP_BLOCK_SIZE || dmp_getInt(buffer + 116) == 0) return DMP_ERROR_FORMAT;
+	
+	memset(header, 0, sizeof(dmp_header));
+	header->cartridgeType = buffer[12];
+	header->memoryType = buffer[13];
+	memcpy(header->title, buffer + 16, 31);
+	memcpy(header->identifier, buffer + 48, 47);
+	header->romSize = dmp_getInt(buffer + 96);
+	header->saveSize = dmp_getInt(buffer + 100);
+	*tableOffset = dmp_getInt(buffer + 116);
+	return 0;
+}
+
+// Encodes a block table entry (sha1, crc32, retries)
+static void dmp_encodeEntry(unsigned char* entry, char* data, unsigned int length, unsigned char retries) {
+	memset(entry, 0, DMP_ENTRY_SIZE);
+	SHA1((unsigned char*)data, length, entry);
+	dmp_putInt(entry + 20, dmp_crc32(data, length));
+	entry[24] = retries;
+}
+
+// Gets the number of blocks needed for the given size
+static unsigned int dmp_numBlocks(unsigned int size) {
+	return (size + DMP_BLOCK_SIZE - 1) / DMP_BLOCK_SIZE;
+}
+
+// Gets the length of the block at the given index (last block may be short)
+static unsigned int dmp_blockLength(unsigned int size, unsigned int index) {
+	unsigned int start = index * DMP_BLOCK_SIZE;
+	if(start >= size) return 0;
+	if(size - start < DMP_BLOCK_SIZE) return size - start;
+	return DMP_BLOCK_SIZE;
+}
+
+// Computes the standard (zip) crc32 of the given data
+static unsigned int dmp_crc32(char* data, unsigned int length) {
+	unsigned int i, j;
+	if(!dmp_crcTableInit) {
+		for(i=0; i<256; i++) {
+			unsigned int c = i;
+			for(j=0; j<8; j++) c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+			dmp_crcTable[i] = c;
+		}
+		dmp_crcTableInit = 1;
+	}
+	
+	unsigned int crc = 0xFFFFFFFF;
+	for(i=0; i<length; i++) crc = dmp_crcTable[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFF;
+}
+
+// Writes a little endian int to the buffer
+static void dmp_putInt(unsigned char* buffer, unsigned int value) {
+	buffer[0] = value & 0xFF;
+	buffer[1] = (value >> 8) & 0xFF;
+	buffer[2] = (value >> 16) & 0xFF;
+	buffer[3] = (value >> 24) & 0xFF;
+}
+
+// Reads a little endian int from the buffer
+static unsigned int dmp_getInt(unsigned char* buffer) {
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((unsigned int)buffer[3] << 24);
+}
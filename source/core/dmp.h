@@ -0,0 +1,59 @@
+#ifndef DMP_H
+#define DMP_H
+
+#define DMP_BLOCK_SIZE 131072
+
+#define DMP_SECTION_ROM 0
+#define DMP_SECTION_SAVE 1
+
+#define DMP_ERROR_FILE -1
+#define DMP_ERROR_FORMAT -2
+#define DMP_ERROR_SIZE -3
+#define DMP_ERROR_CORRUPT -4
+
+typedef void dmp_writer;
+typedef void dmp_reader;
+
+typedef struct {
+	char cartridgeType;
+	char memoryType;
+	char title[32];
+	char identifier[48];
+	unsigned int romSize;
+	unsigned int saveSize;
+} dmp_header;
+
+// Creates a dump container and writes its header (null on failure)
+dmp_writer* dmp_create(const char* filename, dmp_header* header);
+
+// Appends the next ROM block along with the number of retries it took to read
+int dmp_writeROMBlock(dmp_writer* writer, char* data, unsigned int length, unsigned char retries);
+
+// Appends the next Save block along with the number of retries it took to read (after all ROM blocks)
+int dmp_writeSaveBlock(dmp_writer* writer, char* data, unsigned int length, unsigned char retries);
+
+// Writes the block tables and closes the dump container (returns 0 if all blocks were written)
+int dmp_close(dmp_writer* writer);
+
+// Reads the header of a dump container
+int dmp_readHeader(const char* filename, dmp_header* header);
+
+// Reads and checks a single block of a dump container (returns the block length, data is only written if the block checks out)
+int dmp_readBlock(const char* filename, char section, unsigned int index, char* data, unsigned char* retries);
+
+// Opens a dump container for reading several blocks (null on failure)
+dmp_reader* dmp_openReader(const char* filename, dmp_header* header);
+
+// Reads and checks a single block of an open dump container (returns the block length, data is only written if the block checks out)
+int dmp_readBlockFrom(dmp_reader* reader, char section, unsigned int index, char* data, unsigned char* retries);
+
+// Closes a dump container opened for reading
+void dmp_closeReader(dmp_reader* reader);
+
+// Checks every block of a dump container against its hashes (returns the number of bad blocks)
+int dmp_verify(const char* filename);
+
+// Exports a dump container back to plain ROM and Save files (either filename can be null)
+int dmp_export(const char* filename, const char* romFilename, const char* saveFilename);
+
+#endif /* DMP_H */
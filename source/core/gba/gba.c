@@ -6,8 +6,11 @@
 #include "gba_flash.h"
 #include "gba_eeprom.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include "egpio.h"
 
+#define GBA_SAVE_BLOCK_BATCH 32
+
 //TODOs:
 //-Atmel flash read/write is untested
 
@@ -94,7 +97,7 @@ char gba_loadHeader()
 	for(i = 0; i < 2; i++) gba_makerCode[i] = header[0xB0 + i];
 	
 	//determine rom size
-	gba_romSize = gba_rom_determineSize();
+	gba_romSize = gba_rom_determineSize(header);
 	
 	//determine save type and size
 	gba_saveType = gba_save_determineType();
@@ -177,7 +180,13 @@ int gba_readROM(char* buffer, unsigned int length)
 	
 	if(length > gba_romSize) length = gba_romSize;
 	if(length > 0) {
-		gba_rom_readAt(buffer, 0x00, length);
+		//re-latch the address every chunk
+		unsigned int start;
+		for(start = 0; start < length; start += GBA_ROM_CHUNK_SIZE) {
+			unsigned int chunkLength = GBA_ROM_CHUNK_SIZE;
+			if(start + chunkLength > length) chunkLength = length - start;
+			gba_rom_readAt(buffer + start, start, chunkLength);
+		}
 	}
 	
 	//power down the cart slot
@@ -185,6 +194,57 @@ int gba_readROM(char* buffer, unsigned int length)
 	return length;
 }
 
+// Read part of the ROM of a connected GBA cartridge at the given start and returns the size
+int gba_readROMAt(char* buffer, unsigned int start, unsigned int length)
+{
+	if(gba_verifyLoaded() == 0) gba_loadHeader();
+	if(gba_loaded == 0) {
+		//power down the cart slot
+		gba_cart_powerDown();
+		return GBA_ERROR_NO_CARTRIDGE;
+	}
+	
+	if(start >= gba_romSize) length = 0;
+	else if(start + length > gba_romSize) length = gba_romSize - start;
+	if(length > 0) {
+		//re-latch the address every chunk
+		unsigned int offset;
+		for(offset = 0; offset < length; offset += GBA_ROM_CHUNK_SIZE) {
+			unsigned int chunkLength = GBA_ROM_CHUNK_SIZE;
+			if(offset + chunkLength > length) chunkLength = length - offset;
+			gba_rom_readAt(buffer + offset, start + offset, chunkLength);
+		}
+	}
+	
+	//power down the cart slot
+	gba_cart_powerDown();
+	return length;
+}
+
+// Read the ROM of a connected GBA cartridge in chunks starting at the given chunk and returns the next chunk index
+int gba_readROMChunks(unsigned int firstChunk, gba_chunkHandler handler, void* param)
+{
+	if(gba_verifyLoaded() == 0) gba_loadHeader();
+	if(gba_loaded == 0) {
+		//power down the cart slot
+		gba_cart_powerDown();
+		return GBA_ERROR_NO_CARTRIDGE;
+	}
+	
+	char* chunk = (char*)malloc(GBA_ROM_CHUNK_SIZE);
+	if(chunk == 0) {
+		//power down the cart slot
+		gba_cart_powerDown();
+		return GBA_ERROR_NO_CARTRIDGE;
+	}
+	int next = gba_rom_readChunks(chunk, firstChunk, gba_romSize, handler, param);
+	free(chunk);
+	
+	//power down the cart slot
+	gba_cart_powerDown();
+	return next;
+}
+
 // Read the Save Data of a connected GBA cartridge and returns the size
 int gba_readSave(char* buffer, unsigned int length)
 {
@@ -213,6 +273,65 @@ int gba_readSave(char* buffer, unsigned int length)
 	return length;
 }
 
+// Read the Save Data of a connected GBA cartridge in blocks of the given size and order, returns the number of blocks handled
+int gba_readSaveBlocks(unsigned int blockSize, unsigned int* order, unsigned int count, gba_chunkHandler handler, void* param)
+{
+	if(gba_verifyLoaded() == 0) gba_loadHeader();
+	if(gba_loaded == 0) {
+		//power down the cart slot
+		gba_cart_powerDown();
+		return GBA_ERROR_NO_CARTRIDGE;
+	}
+	
+	//flash blocks are read a batch at a time so each batch only switches banks once each way
+	unsigned int batchSize = 1;
+	if(gba_saveType == GBA_SAVE_TYPE_FLASH_512K || gba_saveType == GBA_SAVE_TYPE_FLASH_1M) batchSize = GBA_SAVE_BLOCK_BATCH;
+	char* blocks = (char*)malloc(blockSize * batchSize);
+	if(blocks == 0) {
+		//power down the cart slot
+		gba_cart_powerDown();
+		return 0;
+	}
+	
+	//sram and eeprom blocks are read one at a time so the handler can stop at any point
+	unsigned int i, j;
+	unsigned int handled = count;
+	gba_flash_range ranges[GBA_SAVE_BLOCK_BATCH];
+	unsigned int lengths[GBA_SAVE_BLOCK_BATCH];
+	for(i = 0; i < count && handled == count; i += batchSize) {
+		unsigned int batchCount = count - i;
+		if(batchCount > batchSize) batchCount = batchSize;
+		for(j = 0; j < batchCount; j++) {
+			unsigned int start = order[i + j] * blockSize;
+			lengths[j] = blockSize;
+			if(start >= gba_saveSize) start = lengths[j] = 0;
+			else if(start + lengths[j] > gba_saveSize) lengths[j] = gba_saveSize - start;
+			ranges[j].buffer = blocks + (j * blockSize);
+			ranges[j].start = start;
+			ranges[j].length = lengths[j];
+			
+			if(lengths[j] == 0) continue;
+			if(gba_saveType == GBA_SAVE_TYPE_SRAM_256K || gba_saveType == GBA_SAVE_TYPE_SRAM_512K) gba_sram_readAt(ranges[j].buffer, start, lengths[j]);
+			if(gba_saveType == GBA_SAVE_TYPE_EEPROM_4K || gba_saveType == GBA_SAVE_TYPE_EEPROM_64K) gba_eeprom_readAt(ranges[j].buffer, start, lengths[j], gba_saveSize);
+		}
+		if(gba_saveType == GBA_SAVE_TYPE_FLASH_512K || gba_saveType == GBA_SAVE_TYPE_FLASH_1M) gba_flash_readRanges(ranges, batchCount);
+		
+		//hand out the blocks in the requested order
+		for(j = 0; j < batchCount; j++) {
+			if(lengths[j] == 0) continue;
+			if(handler(ranges[j].buffer, order[i + j], lengths[j], param) != 0) {
+				handled = i + j + 1;
+				break;
+			}
+		}
+	}
+	free(blocks);
+	
+	//power down the cart slot
+	gba_cart_powerDown();
+	return handled;
+}
+
 // Write the Save Data to a connected GBA cartridge
 int gba_writeSave(char* buffer, unsigned int length)
 {
@@ -229,18 +348,45 @@ int gba_writeSave(char* buffer, unsigned int length)
 		return 0;
 	}
 	
+	int result = 0;
 	if(length > gba_saveSize) length = gba_saveSize;
 	if(length > 0) {
 		if(gba_saveType == GBA_SAVE_TYPE_SRAM_256K || gba_saveType == GBA_SAVE_TYPE_SRAM_512K) gba_sram_write(buffer, length);
-		if(gba_saveType == GBA_SAVE_TYPE_FLASH_512K || gba_saveType == GBA_SAVE_TYPE_FLASH_1M) gba_flash_write(buffer, length);
+		if(gba_saveType == GBA_SAVE_TYPE_FLASH_512K || gba_saveType == GBA_SAVE_TYPE_FLASH_1M) result = gba_flash_write(buffer, length);
 		if(gba_saveType == GBA_SAVE_TYPE_EEPROM_4K || gba_saveType == GBA_SAVE_TYPE_EEPROM_64K) gba_eeprom_write(buffer, length);
 	}
 	
 	//power down the cart slot
 	gba_cart_powerDown();
+	if(result < 0) return GBA_ERROR_WRITE_FAILED;
 	return length;
 }
 
+// Reads a cheap fingerprint of the connected GBA cartridge header (0 if no valid header)
+unsigned int gba_readFingerprint()
+{
+	int i;
+	
+	//read just the title through checksum area of the header
+	char header[0x20];
+	gba_rom_readAt(header, 0xA0, 0x20);
+	
+	//power down the cart slot
+	gba_cart_powerDown();
+	
+	//verify header checksum
+	unsigned char chk=0;
+	for(i=0x00; i<0x1C; i++) chk = chk - header[i];
+	chk = chk - 0x19;
+	if(header[0x1D] != chk) return 0;
+	
+	//fnv-1a hash of the header area
+	unsigned int hash = 2166136261u;
+	for(i=0x00; i<0x20; i++) hash = (hash ^ (unsigned char)header[i]) * 16777619u;
+	if(hash == 0) hash = 1;
+	return hash;
+}
+
 // Dumps the first 400 bytes of the connected GBA cartridge
 void gba_dumpHeader(char* data)
 {
@@ -12,6 +12,9 @@
 #define GBA_ERROR_NO_CARTRIDGE -1
 #define GBA_ERROR_CARTRIDGE_CHANGED -2
 #define GBA_ERROR_CARTRIDGE_NOT_LOADED -3
+#define GBA_ERROR_WRITE_FAILED -4
+
+typedef int (*gba_chunkHandler)(char* chunk, unsigned int chunkIndex, unsigned int length, void* param);
 
 // Setup and initialize the GBA utils
 int gba_init();
@@ -49,12 +52,24 @@ unsigned int gba_getSaveSize();
 // Read the ROM of a connected GBA cartridge and returns the size
 int gba_readROM(char* buffer, unsigned int length);
 
+// Read part of the ROM of a connected GBA cartridge at the given start and returns the size
+int gba_readROMAt(char* buffer, unsigned int start, unsigned int length);
+
+// Read the ROM of a connected GBA cartridge in chunks starting at the given chunk and returns the next chunk index
+int gba_readROMChunks(unsigned int firstChunk, gba_chunkHandler handler, void* param);
+
 // Read the Save Data of a connected GBA cartridge and returns the size
 int gba_readSave(char* buffer, unsigned int length);
 
+// Read the Save Data of a connected GBA cartridge in blocks of the given size and order, returns the number of blocks handled
+int gba_readSaveBlocks(unsigned int blockSize, unsigned int* order, unsigned int count, gba_chunkHandler handler, void* param);
+
 // Write the Save Data to a connected GBA cartridge
 int gba_writeSave(char* buffer, unsigned int length);
 
+// Reads a cheap fingerprint of the connected GBA cartridge header (0 if no valid header)
+unsigned int gba_readFingerprint();
+
 // Dumps the first 400 bytes of the connected GBA cartridge
 void gba_dumpHeader(char* data);
 
@@ -17,6 +17,12 @@ static char gba_eeprom_readByte(char ignoreStart);
 
 // Reads the EEPROM of a connected GBA cartridge
 void gba_eeprom_read(char* buffer, unsigned int length)
+{
+	gba_eeprom_readAt(buffer, 0, length, length);
+}
+
+// Reads the EEPROM from the given address (multiple of 8) of a connected GBA cartridge with the given EEPROM size
+void gba_eeprom_readAt(char* buffer, unsigned int start, unsigned int length, unsigned int size)
 {
 	int i, j;
 	
@@ -26,8 +32,8 @@ void gba_eeprom_read(char* buffer, unsigned int length)
 	//determine if 4K or 64K and start loop
 	int index = 0;
 	int numReads = 64;
-	if(length > GBA_SAVE_SIZE_4K) numReads = 1024;
-	for(j = 0; j < numReads && index < length; j++) {
+	if(size > GBA_SAVE_SIZE_4K) numReads = 1024;
+	for(j = start / 8; j < numReads && index < length; j++) {
 		
 		//setup for EEPROM write
 		egpio_setPortDir(EX_GPIO_PORTA, 0x00);
@@ -35,7 +41,7 @@ void gba_eeprom_read(char* buffer, unsigned int length)
 		egpio_writePort(EX_GPIO_PORTD, _1(GBA_WR + GBA_CS2) & _0(GBA_CS + GBA_CLK + GBA_PWR));
 		
 		//write the read command to EEPROM
-		if(length > GBA_SAVE_SIZE_4K) {
+		if(size > GBA_SAVE_SIZE_4K) {
 			gba_eeprom_writeByte(EEPROM_READ | (char)((j >> 8) & 0x03), 0);
 			gba_eeprom_writeByte((char) j, 1);
 		} else {
@@ -4,6 +4,9 @@
 // Reads the EEPROM of a connected GBA cartridge
 void gba_eeprom_read(char* buffer, unsigned int length);
 
+// Reads the EEPROM from the given address (multiple of 8) of a connected GBA cartridge with the given EEPROM size
+void gba_eeprom_readAt(char* buffer, unsigned int start, unsigned int length, unsigned int size);
+
 // Writes to the EEPROM of a connected GBA cartridge
 void gba_eeprom_write(char* buffer, unsigned int length);
 
@@ -4,33 +4,50 @@
 #include "gba_flash.h"
 #include "egpio.h"
 #include "spi.h"
+#include <stdio.h>
 
 #define _1(x)   (x)
 #define _0(x)   ((unsigned char)~(x))
 
+#define GBA_FLASH_ATMEL_PAGE_SIZE 128
+#define GBA_FLASH_ATMEL_PAGE_RETRIES 3
+#define GBA_FLASH_ATMEL_POLL_TIMEOUT 400
+#define GBA_FLASH_BANK_SIGNATURE_SIZE 8
+#define GBA_FLASH_BANK_POLL_TIMEOUT 50
+
+// Data
+static char gba_flash_bankSignature[GBA_FLASH_BANK_SIGNATURE_SIZE];
+static char gba_flash_bankDistinct = 0;
+
 // Helper functions
-static void gba_flash_writeAtmel(char* buffer, unsigned int length);
+static int gba_flash_writeAtmel(char* buffer, unsigned int length);
 static void gba_flash_writeOther(char* buffer, unsigned int length);
 static void gba_flash_writeBus(int address, char data);
+static void gba_flash_readBank(char* buffer, unsigned int offset, unsigned int length);
+static void gba_flash_switchBank(char bank);
+static void gba_flash_readPage(char* buffer, int address, unsigned int length);
+static int gba_flash_comparePage(char* page, char* data, unsigned int length);
+static void gba_flash_pollStatus(int address, char data);
+static char gba_flash_readBus(int address);
 
 // Reads the Flash/SRAM of a connected GBA cartridge
 void gba_flash_read(char* buffer, unsigned int length)
 {
-	//read as much as possible from bank 0
-	unsigned int numReads = length;
-	if(length > GBA_SAVE_SIZE_512K) numReads = GBA_SAVE_SIZE_512K;
-	gba_flash_readAt(buffer, 0, numReads);
-	
-	//read more from bank 1 if needed
-	if(length > GBA_SAVE_SIZE_512K) {
-		buffer += GBA_SAVE_SIZE_512K;
-		length -= GBA_SAVE_SIZE_512K;
-		gba_flash_readAt(buffer, GBA_SAVE_SIZE_512K, length);
-	}
+	gba_flash_readAt(buffer, 0, length);
 }
 
 // Reads Save data like Flash or SRAM from the given address
 void gba_flash_readAt(char* buffer, unsigned int start, unsigned int length)
+{
+	gba_flash_range range;
+	range.buffer = buffer;
+	range.start = start;
+	range.length = length;
+	gba_flash_readRanges(&range, 1);
+}
+
+// Reads multiple ranges of Flash/SRAM switching banks at most once each way
+void gba_flash_readRanges(gba_flash_range* ranges, int count)
 {
 	int i;
 	
@@ -39,41 +56,31 @@ void gba_flash_readAt(char* buffer, unsigned int start, unsigned int length)
 	
 	//pull GBA_CS2 pin low while we read data
 	egpio_writePort(EX_GPIO_PORTD, _1(GBA_CS + GBA_WR) & _0(GBA_CS2 + GBA_CLK + GBA_PWR));
-	
-	//switch to bank 1 if starting past 512K
-	if(start >= GBA_SAVE_SIZE_512K) {
-		egpio_setPortDir(EX_GPIO_PORTC, 0x00);
-		gba_flash_writeBus(0x5555, 0xAA);
-		gba_flash_writeBus(0x2AAA, 0x55);
-		gba_flash_writeBus(0x5555, 0xB0);
-		gba_flash_writeBus(0x0000, 0x01);
-		gba_cart_delay(500000); //5ms
-	}
-		
-	//read the data
 	egpio_setPortDir(EX_GPIO_PORTC, 0xFF);
-	unsigned int offset = start;
-	if(start >= GBA_SAVE_SIZE_512K) offset -= GBA_SAVE_SIZE_512K;
-	for(i = 0; i < length; i++) {
-		
-		//set the address
-		unsigned int address = offset + i;
-		egpio_writePortAB((char) address, (char) (address >> 8));
-	
-		//pull RD pin low while we read data
-		spi_writeGPIO(GBA_GPIO_RD, 0x00);
-		buffer[i] = egpio_readPort(EX_GPIO_PORTC);
-		spi_writeGPIO(GBA_GPIO_RD, 0x01);
+	
+	//read everything that falls in bank 0
+	char needsBank1 = 0;
+	for(i = 0; i < count; i++) {
+		unsigned int start = ranges[i].start;
+		unsigned int end = ranges[i].start + ranges[i].length;
+		if(end > GBA_SAVE_SIZE_512K) {
+			end = GBA_SAVE_SIZE_512K;
+			needsBank1 = 1;
+		}
+		if(start < end) gba_flash_readBank(ranges[i].buffer, start, end - start);
 	}
-		
-	//switch back to bank 0 if starting past 512K
-	if(start >= GBA_SAVE_SIZE_512K) {
-		egpio_setPortDir(EX_GPIO_PORTC, 0x00);
-		gba_flash_writeBus(0x5555, 0xAA);
-		gba_flash_writeBus(0x2AAA, 0x55);
-		gba_flash_writeBus(0x5555, 0xB0);
-		gba_flash_writeBus(0x0000, 0x00);
-		gba_cart_delay(500000); //5ms
+	
+	//read everything that falls in bank 1
+	if(needsBank1) {
+		gba_flash_switchBank(1);
+		egpio_setPortDir(EX_GPIO_PORTC, 0xFF);
+		for(i = 0; i < count; i++) {
+			unsigned int start = ranges[i].start;
+			unsigned int end = ranges[i].start + ranges[i].length;
+			if(start < GBA_SAVE_SIZE_512K) start = GBA_SAVE_SIZE_512K;
+			if(start < end) gba_flash_readBank(ranges[i].buffer + (start - ranges[i].start), start - GBA_SAVE_SIZE_512K, end - start);
+		}
+		gba_flash_switchBank(0);
 	}
 		
 	//pull RD and GBA_CS2 back to high
@@ -81,9 +88,10 @@ void gba_flash_readAt(char* buffer, unsigned int start, unsigned int length)
 	spi_writeGPIO(GBA_GPIO_RD, 0x01);
 }
 
-// Writes to the Flash memory of a connected GBA cartridge
-void gba_flash_write(char* buffer, unsigned int length)
+// Writes to the Flash memory of a connected GBA cartridge (returns 0 on success)
+int gba_flash_write(char* buffer, unsigned int length)
 {
+	int result = 0;
 	char manufacturerId, deviceId;
 	char flashManufacturer = gba_flash_checkManufacturer(&manufacturerId, &deviceId);
 	
@@ -92,7 +100,7 @@ void gba_flash_write(char* buffer, unsigned int length)
 	
 	//write flash according to manufacturer
 	if(flashManufacturer == GBA_FLASH_MANUFACTURER_ATMEL) {
-		gba_flash_writeAtmel(buffer, length);
+		result = gba_flash_writeAtmel(buffer, length);
 	} else if(flashManufacturer == GBA_FLASH_MANUFACTURER_OTHER) {
 		gba_flash_writeOther(buffer, length);
 	}
@@ -100,6 +108,7 @@ void gba_flash_write(char* buffer, unsigned int length)
 	//pull GBA_CS2, RD and WR back to high
 	egpio_writePort(EX_GPIO_PORTD, _1(GBA_CS + GBA_WR + GBA_CS2) & _0(GBA_CLK + GBA_PWR));
 	spi_writeGPIO(GBA_GPIO_RD, 0x01);
+	return result;
 }
 
 // Reads the manufacturer code of the flash chip
@@ -150,24 +159,49 @@ char gba_flash_checkManufacturer(char* manufacturerId, char* deviceId)
 	return GBA_FLASH_MANUFACTURER_UNKNOWN;
 }
 
-// Writes to the Flash memory of a connected GBA cartridge (atmel manufacturer)
-static void gba_flash_writeAtmel(char* buffer, unsigned int length) {
-	int i, j;
+// Writes to the Flash memory of a connected GBA cartridge (atmel manufacturer, returns -1 if a page fails to verify)
+static int gba_flash_writeAtmel(char* buffer, unsigned int length) {
+	char page[GBA_FLASH_ATMEL_PAGE_SIZE];
+	int i, j, k;
 	
 	//pull GBA_CS2 pin low while we write data
 	egpio_writePort(EX_GPIO_PORTD, _1(GBA_CS + GBA_WR) & _0(GBA_CS2 + GBA_CLK + GBA_PWR));
 	
-	for(i = 0; i < length; i += 128) {
+	for(i = 0; i < length; i += GBA_FLASH_ATMEL_PAGE_SIZE) {
+		unsigned int pageLength = GBA_FLASH_ATMEL_PAGE_SIZE;
+		if(i + pageLength > length) pageLength = length - i;
 		
-		//write the bus cycles for sector program
-		gba_flash_writeBus(0x5555, 0xAA);
-		gba_flash_writeBus(0x2AAA, 0x55);
-		gba_flash_writeBus(0x5555, 0xA0);
-		for (j = 0; j < 128; j++) {
-			gba_flash_writeBus(i + j, buffer[i]);
+		//skip pages that already hold the data
+		gba_flash_readPage(page, i, pageLength);
+		if(gba_flash_comparePage(page, buffer + i, pageLength) == 0) continue;
+		
+		for(k = 0; k < GBA_FLASH_ATMEL_PAGE_RETRIES; k++) {
+			
+			//partial pages keep their remaining bytes (the whole sector is reprogrammed)
+			if(pageLength < GBA_FLASH_ATMEL_PAGE_SIZE) gba_flash_readPage(page, i, GBA_FLASH_ATMEL_PAGE_SIZE);
+			for(j = 0; j < pageLength; j++) page[j] = buffer[i + j];
+			
+			//write the bus cycles for sector program
+			gba_flash_writeBus(0x5555, 0xAA);
+			gba_flash_writeBus(0x2AAA, 0x55);
+			gba_flash_writeBus(0x5555, 0xA0);
+			for(j = 0; j < GBA_FLASH_ATMEL_PAGE_SIZE; j++) {
+				gba_flash_writeBus(i + j, page[j]);
+			}
+			
+			//wait for the internal program cycle to finish
+			gba_flash_pollStatus(i + GBA_FLASH_ATMEL_PAGE_SIZE - 1, page[GBA_FLASH_ATMEL_PAGE_SIZE - 1]);
+			
+			//verify the page
+			gba_flash_readPage(page, i, pageLength);
+			if(gba_flash_comparePage(page, buffer + i, pageLength) == 0) break;
+		}
+		if(k == GBA_FLASH_ATMEL_PAGE_RETRIES) {
+			fprintf(stderr, "gba_flash_writeAtmel: failed to verify page at 0x%04X\n", i);
+			return -1;
 		}
-		gba_cart_delay(2000000); //20ms
 	}
+	return 0;
 }
 
 // Writes to the Flash memory of a connected GBA cartridge (other manufacturer)
@@ -205,11 +239,7 @@ static void gba_flash_writeOther(char* buffer, unsigned int length) {
 	if(length > GBA_SAVE_SIZE_512K) {
 		
 		//switch to bank 1
-		gba_flash_writeBus(0x5555, 0xAA);
-		gba_flash_writeBus(0x2AAA, 0x55);
-		gba_flash_writeBus(0x5555, 0xB0);
-		gba_flash_writeBus(0x0000, 0x01);
-		gba_cart_delay(500000); //5ms
+		gba_flash_switchBank(1);
 		
 		//write the rest of the data
 		numWrites = length - GBA_SAVE_SIZE_512K;
@@ -235,11 +265,7 @@ static void gba_flash_writeOther(char* buffer, unsigned int length) {
 		}
 		
 		//switch back to bank 0
-		gba_flash_writeBus(0x5555, 0xAA);
-		gba_flash_writeBus(0x2AAA, 0x55);
-		gba_flash_writeBus(0x5555, 0xB0);
-		gba_flash_writeBus(0x0000, 0x00);
-		gba_cart_delay(500000); //5ms
+		gba_flash_switchBank(0);
 	}
 }
 
@@ -251,3 +277,95 @@ static void gba_flash_writeBus(int address, char data) {
 	egpio_writePort(EX_GPIO_PORTD, _1(GBA_CS) & _0(GBA_WR + GBA_CS2 + GBA_CLK + GBA_PWR));
 	egpio_writePort(EX_GPIO_PORTD, _1(GBA_CS + GBA_WR) & _0(GBA_CS2 + GBA_CLK + GBA_PWR));
 }
+
+// Reads from the currently active bank (data bus must be set as input)
+static void gba_flash_readBank(char* buffer, unsigned int offset, unsigned int length) {
+	int i;
+	for(i = 0; i < length; i++) buffer[i] = gba_flash_readBus(offset + i);
+}
+
+// Switches the active bank and confirms the switch on readback (leaves the data bus as output)
+static void gba_flash_switchBank(char bank) {
+	//note: bank 1 is confirmed once the signature stops matching bank 0, bank 0 once it matches again
+	//note: when the signature can't tell the banks apart both directions wait the full 5ms
+	int i, j;
+	char signature[GBA_FLASH_BANK_SIGNATURE_SIZE];
+	
+	//remember what bank 0 looks like before leaving it
+	egpio_setPortDir(EX_GPIO_PORTC, 0xFF);
+	if(bank == 1) {
+		for(j = 0; j < GBA_FLASH_BANK_SIGNATURE_SIZE; j++) {
+			gba_flash_bankSignature[j] = gba_flash_readBus(j * (GBA_SAVE_SIZE_512K / GBA_FLASH_BANK_SIGNATURE_SIZE));
+		}
+	}
+	
+	//write the bus cycles for bank switch
+	egpio_setPortDir(EX_GPIO_PORTC, 0x00);
+	gba_flash_writeBus(0x5555, 0xAA);
+	gba_flash_writeBus(0x2AAA, 0x55);
+	gba_flash_writeBus(0x5555, 0xB0);
+	gba_flash_writeBus(0x0000, bank);
+	
+	//banks that looked the same on the way out can't confirm the way back
+	if(bank == 0 && gba_flash_bankDistinct == 0) {
+		gba_cart_delay(500000); //5ms
+		return;
+	}
+	
+	//poll until the expected bank shows up (falls back to the full 5ms when the banks look the same)
+	if(bank == 1) gba_flash_bankDistinct = 0;
+	egpio_setPortDir(EX_GPIO_PORTC, 0xFF);
+	for(i = 0; i < GBA_FLASH_BANK_POLL_TIMEOUT; i++) {
+		char same = 1;
+		for(j = 0; j < GBA_FLASH_BANK_SIGNATURE_SIZE; j++) {
+			signature[j] = gba_flash_readBus(j * (GBA_SAVE_SIZE_512K / GBA_FLASH_BANK_SIGNATURE_SIZE));
+			if(signature[j] != gba_flash_bankSignature[j]) same = 0;
+		}
+		if(same == (bank == 0)) break;
+		gba_cart_delay(10000); //100us
+	}
+	if(bank == 1 && i < GBA_FLASH_BANK_POLL_TIMEOUT) gba_flash_bankDistinct = 1;
+	egpio_setPortDir(EX_GPIO_PORTC, 0x00);
+}
+
+// Reads a page of flash back for comparison (leaves the data bus as output)
+static void gba_flash_readPage(char* buffer, int address, unsigned int length) {
+	int i;
+	egpio_setPortDir(EX_GPIO_PORTC, 0xFF);
+	for(i = 0; i < length; i++) buffer[i] = gba_flash_readBus(address + i);
+	egpio_setPortDir(EX_GPIO_PORTC, 0x00);
+}
+
+// Compares a page of flash with the given data
+static int gba_flash_comparePage(char* page, char* data, unsigned int length) {
+	int i;
+	for(i = 0; i < length; i++) {
+		if(page[i] != data[i]) return 1;
+	}
+	return 0;
+}
+
+// Polls the flash until the program cycle completes (data polling on the last byte loaded)
+static void gba_flash_pollStatus(int address, char data) {
+	int i;
+	egpio_setPortDir(EX_GPIO_PORTC, 0xFF);
+	for(i = 0; i < GBA_FLASH_ATMEL_POLL_TIMEOUT; i++) {
+		
+		//bit 7 reads back inverted and bit 6 toggles until the cycle completes
+		char status1 = gba_flash_readBus(address);
+		char status2 = gba_flash_readBus(address);
+		if(((status1 ^ data) & 0x80) == 0 && ((status1 ^ status2) & 0x40) == 0) break;
+		gba_cart_delay(10000); //100us
+	}
+	egpio_setPortDir(EX_GPIO_PORTC, 0x00);
+}
+
+// Read a bus cycle from flash (data bus must be set as input)
+static char gba_flash_readBus(int address) {
+	egpio_writePortAB((char) address, (char) (address >> 8));
+	
+	spi_writeGPIO(GBA_GPIO_RD, 0x00);
+	char data = egpio_readPort(EX_GPIO_PORTC);
+	spi_writeGPIO(GBA_GPIO_RD, 0x01);
+	return data;
+}
@@ -5,14 +5,23 @@
 #define GBA_FLASH_MANUFACTURER_OTHER 0x01
 #define GBA_FLASH_MANUFACTURER_UNKNOWN 0x03
 
+typedef struct {
+	char* buffer;
+	unsigned int start;
+	unsigned int length;
+} gba_flash_range;
+
 // Reads the Flash of a connected GBA cartridge
 void gba_flash_read(char* buffer, unsigned int length);
 
 // Reads the Flash from the given address of a connected GBA cartridge
 void gba_flash_readAt(char* buffer, unsigned int start, unsigned int length);
 
-// Writes to the Flash memory of a connected GBA cartridge
-void gba_flash_write(char* buffer, unsigned int length);
+// Reads multiple ranges of Flash switching banks at most once each way
+void gba_flash_readRanges(gba_flash_range* ranges, int count);
+
+// Writes to the Flash memory of a connected GBA cartridge (returns 0 on success)
+int gba_flash_write(char* buffer, unsigned int length);
 
 // Reads the manufacturer code of the Flash chip
 char gba_flash_checkManufacturer(char* manufacturerId, char* deviceId);
@@ -7,6 +7,23 @@
 #define _1(x)   (x)
 #define _0(x)   ((unsigned char)~(x))
 
+#define GBA_ROM_SIGNATURE_START 0xA0
+#define GBA_ROM_SIGNATURE_SIZE 32
+#define GBA_ROM_SIZE_CACHE_ENTRIES 32
+
+// Data
+static struct {
+	char gameCode[4];
+	char checksum;
+	int romSize;
+} gba_rom_sizeCache[GBA_ROM_SIZE_CACHE_ENTRIES];
+static int gba_rom_sizeCacheCount = 0;
+static int gba_rom_sizeCacheNext = 0;
+
+// Helper functions
+static char gba_rom_checkMirror(char* header, unsigned int size);
+static char gba_rom_compare(char* a, char* b, unsigned int length);
+
 // Read the ROM of a connected GBA cartridge at the given start and length
 void gba_rom_readAt(char* buffer, unsigned int start, unsigned int length)
 {
@@ -41,49 +58,71 @@ void gba_rom_readAt(char* buffer, unsigned int start, unsigned int length)
 	spi_writeGPIO(GBA_GPIO_RD, 0x01);
 }
 
+// Reads the ROM in chunks (re-latching the address for each) and passes them to the handler, returns the next chunk index
+unsigned int gba_rom_readChunks(char* chunk, unsigned int firstChunk, unsigned int length, gba_chunkHandler handler, void* param)
+{
+	unsigned int chunkIndex = firstChunk;
+	while(chunkIndex * GBA_ROM_CHUNK_SIZE < length) {
+		unsigned int start = chunkIndex * GBA_ROM_CHUNK_SIZE;
+		unsigned int chunkLength = GBA_ROM_CHUNK_SIZE;
+		if(start + chunkLength > length) chunkLength = length - start;
+		
+		//a fresh address latch per chunk keeps a bus glitch from running past the chunk
+		gba_rom_readAt(chunk, start, chunkLength);
+		chunkIndex++;
+		
+		//let the handler stop the read early
+		if(handler(chunk, chunkIndex - 1, chunkLength, param) != 0) break;
+	}
+	return chunkIndex;
+}
+
 // Try to figure out the connected GBA cartridge ROM size
-int gba_rom_determineSize()
+int gba_rom_determineSize(char* header)
 {
-	//note: based on the assumption that the rom chips internal counter rolls back to zero (the header)
-	int i, match;
-	char buffer[200];
-	
-	//read header
-	char header[192];
-	gba_rom_readAt(header, 0x00, 192);
+	//note: based on the assumption that the rom chip ignores the address lines above its size (reads mirror the header)
+	int i;
 	
-	//4MB?
-	match = 1;
-	gba_rom_readAt(buffer, GBA_ROM_SIZE_4MB - 8, 200);
-	for(i = 0; i < 192; i++) {
-		if(buffer[i + 8] != header[i]) {
-			match = 0;
-			break;
+	//already seen this cartridge?
+	for(i = 0; i < gba_rom_sizeCacheCount; i++) {
+		if(gba_rom_sizeCache[i].checksum == header[0xBD] && gba_rom_compare(gba_rom_sizeCache[i].gameCode, header + 0xAC, 4)) {
+			return gba_rom_sizeCache[i].romSize;
 		}
 	}
-	if(match == 1) return GBA_ROM_SIZE_4MB;
 	
-	//8MB?
-	match = 1;
-	gba_rom_readAt(buffer, GBA_ROM_SIZE_8MB - 8, 200);
-	for(i = 0; i < 192; i++) {
-		if(buffer[i + 8] != header[i]) {
-			match = 0;
-			break;
-		}
+	//binary search the mirror boundaries (8MB splits 4/8 from 16/32)
+	int romSize;
+	if(gba_rom_checkMirror(header, GBA_ROM_SIZE_8MB)) {
+		if(gba_rom_checkMirror(header, GBA_ROM_SIZE_4MB)) romSize = GBA_ROM_SIZE_4MB;
+		else romSize = GBA_ROM_SIZE_8MB;
+	} else {
+		if(gba_rom_checkMirror(header, GBA_ROM_SIZE_16MB)) romSize = GBA_ROM_SIZE_16MB;
+		else romSize = GBA_ROM_SIZE_32MB;
 	}
-	if(match == 1) return GBA_ROM_SIZE_8MB;
 	
-	//16MB?
-	match = 1;
-	gba_rom_readAt(buffer, GBA_ROM_SIZE_16MB - 8, 200);
-	for(i = 0; i < 192; i++) {
-		if(buffer[i + 8] != header[i]) {
-			match = 0;
-			break;
-		}
-	}
-	if(match == 1) return GBA_ROM_SIZE_16MB;
+	//remember the result (oldest entry gets replaced when full)
+	int index = gba_rom_sizeCacheNext;
+	gba_rom_sizeCacheNext = (gba_rom_sizeCacheNext + 1) % GBA_ROM_SIZE_CACHE_ENTRIES;
+	if(gba_rom_sizeCacheCount < GBA_ROM_SIZE_CACHE_ENTRIES) gba_rom_sizeCacheCount++;
+	for(i = 0; i < 4; i++) gba_rom_sizeCache[index].gameCode[i] = header[0xAC + i];
+	gba_rom_sizeCache[index].checksum = header[0xBD];
+	gba_rom_sizeCache[index].romSize = romSize;
 	
-	return GBA_ROM_SIZE_32MB;
+	return romSize;
+}
+
+// Checks if the header signature shows up again at the given size
+static char gba_rom_checkMirror(char* header, unsigned int size) {
+	char signature[GBA_ROM_SIGNATURE_SIZE];
+	gba_rom_readAt(signature, size + GBA_ROM_SIGNATURE_START, GBA_ROM_SIGNATURE_SIZE);
+	return gba_rom_compare(signature, header + GBA_ROM_SIGNATURE_START, GBA_ROM_SIGNATURE_SIZE);
+}
+
+// Compares the given bytes
+static char gba_rom_compare(char* a, char* b, unsigned int length) {
+	int i;
+	for(i = 0; i < length; i++) {
+		if(a[i] != b[i]) return 0;
+	}
+	return 1;
 }
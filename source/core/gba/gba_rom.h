@@ -1,15 +1,21 @@
 #ifndef GBA_ROM_H
 #define GBA_ROM_H
 
+#include "gba.h"
+
 #define GBA_ROM_SIZE_4MB 4194304
 #define GBA_ROM_SIZE_8MB 8388608
 #define GBA_ROM_SIZE_16MB 16777216
 #define GBA_ROM_SIZE_32MB 33554432
+#define GBA_ROM_CHUNK_SIZE 131072
 
 // Read the ROM of a connected GBA cartridge at the given start and length
 void gba_rom_readAt(char* buffer, unsigned int start, unsigned int length);
 
-// Try to figure out the connected GBA cartridge ROM size
-int gba_rom_determineSize();
+// Reads the ROM in chunks (re-latching the address for each) and passes them to the handler, returns the next chunk index
+unsigned int gba_rom_readChunks(char* chunk, unsigned int firstChunk, unsigned int length, gba_chunkHandler handler, void* param);
+
+// Try to figure out the connected GBA cartridge ROM size from its already read header
+int gba_rom_determineSize(char* header);
 
 #endif /* GBA_ROM_H */
@@ -47,18 +47,38 @@ int gba_save_determineType()
 // Checks if the connected GBA cartridge contains an SRAM or Flash chip
 static char gba_save_checkHasFlashOrSRAM() {
 	//note: based on the assumption that if no sram or flash is connected we will just get zeros
-	int i, j, margin;
-	
-	//check for the existence of data
-	char buffer[64];
-	for(i = 0; i < 128; i++) {
-		gba_flash_readAt(buffer, i * (GBA_SAVE_SIZE_512K / 128), 64);
-		int numBits = 0;
-		for(j = 0; j < 64; j++) {
-			numBits += gba_save_countBits(buffer[j]);
+	int i, j, stage, margin;
+	const int stageWindows[3] = { 16, 128, 128 };
+	const int stageWindowSizes[3] = { 16, 16, 64 };
+	
+	//sample spread out windows, widening only while the result is ambiguous
+	//note: windows stay at 16 bytes or more so a couple of noisy bits stay under the margin
+	char buffer[128 * 64];
+	gba_flash_range ranges[128];
+	for(stage = 0; stage < 3; stage++) {
+		int numWindows = stageWindows[stage];
+		int windowSize = stageWindowSizes[stage];
+		for(i = 0; i < numWindows; i++) {
+			ranges[i].buffer = buffer + (i * windowSize);
+			ranges[i].start = i * (GBA_SAVE_SIZE_512K / numWindows);
+			ranges[i].length = windowSize;
+		}
+		gba_flash_readRanges(ranges, numWindows);
+		
+		//any window with enough set bits is clear evidence of a chip
+		int totalBits = 0;
+		margin = ((windowSize * 8) * (100 - LENIENCY_FLASH_OR_SRAM_CHECK)) / 100;
+		for(i = 0; i < numWindows; i++) {
+			int numBits = 0;
+			for(j = 0; j < windowSize; j++) {
+				numBits += gba_save_countBits(buffer[(i * windowSize) + j]);
+			}
+			if(numBits > margin) return 1;
+			totalBits += numBits;
 		}
-		margin = ((64 * 8) * (100 - LENIENCY_FLASH_OR_SRAM_CHECK)) / 100;
-		if(numBits > margin) return 1;
+		
+		//nothing but zeros across every window is clear evidence of no chip
+		if(totalBits == 0 && numWindows == 128) return 0;
 	}
 	
 	return 0;
@@ -118,15 +138,17 @@ static int gba_save_checkFlash() {
 	if(manufacturerId == 0x62 && deviceId == 0x13) return GBA_SAVE_TYPE_FLASH_1M;
 	
 	//backup method to determine size (check start and end of sections for repeat)
-	char start[64];
-	char buffer[64];
+	char start[128];
+	char buffer[128];
 	int diffBits = 0;
-	gba_flash_readAt(start, 0, 64);
-	gba_flash_readAt(buffer, GBA_SAVE_SIZE_512K, 64);
-	for(i = 0; i < 64; i++) diffBits += gba_save_countDiff(start[i], buffer[i]);
-	gba_flash_readAt(start, GBA_SAVE_SIZE_512K - 64, 64);
-	gba_flash_readAt(buffer, GBA_SAVE_SIZE_1M - 64, 64);
-	for(i = 0; i < 64; i++) diffBits += gba_save_countDiff(start[i], buffer[i]);
+	gba_flash_range ranges[4] = {
+		{ start, 0, 64 }, 
+		{ start + 64, GBA_SAVE_SIZE_512K - 64, 64 }, 
+		{ buffer, GBA_SAVE_SIZE_512K, 64 }, 
+		{ buffer + 64, GBA_SAVE_SIZE_1M - 64, 64 }
+	};
+	gba_flash_readRanges(ranges, 4);
+	for(i = 0; i < 128; i++) diffBits += gba_save_countDiff(start[i], buffer[i]);
 	margin = ((128 * 8) * (100 - LENIENCY_FLASH_CHECK)) / 100;
 	if(diffBits < margin) return GBA_SAVE_TYPE_FLASH_512K;
 	
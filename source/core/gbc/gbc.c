@@ -285,6 +285,33 @@ int gbc_readROM(char* buffer, unsigned int length)
 	return length;
 }
 
+// Read a single 16K bank of the ROM of a connected GB cartridge and returns the size
+int gbc_readROMBank(char* buffer, unsigned int bank)
+{
+	if(gbc_verifyLoaded() == 0) gbc_loadHeader();
+	if(gbc_loaded == 0) {
+		//power down the cart slot
+		gbc_cart_powerDown();
+		return GBC_ERROR_NO_CARTRIDGE;
+	}
+	
+	int length = 0;
+	if(bank < gbc_romSize / GBC_16K) {
+		if(gbc_memController == GBC_MEM_CTRL_MBC1) length = gbc_mbc1_readROMBank(buffer, bank);
+		else if(gbc_memController == GBC_MEM_CTRL_MBC2) length = gbc_mbc2_readROMBank(buffer, bank);
+		else if(gbc_memController == GBC_MEM_CTRL_MBC3) length = gbc_mbc3_readROMBank(buffer, bank);
+		else if(gbc_memController == GBC_MEM_CTRL_MBC5) length = gbc_mbc5_readROMBank(buffer, bank);
+		else {
+			gbc_rom_readAt(buffer, bank * GBC_16K, GBC_16K);
+			length = GBC_16K;
+		}
+	}
+	
+	//power down the cart slot
+	gbc_cart_powerDown();
+	return length;
+}
+
 // Read the Save Data of a connected GB cartridge and returns the size
 int gbc_readSave(char* buffer, unsigned int length)
 {
@@ -331,6 +358,34 @@ int gbc_writeSave(char* buffer, unsigned int length)
 	return length;
 }
 
+// Reads a cheap fingerprint of the connected GB cartridge header (0 if no valid header)
+unsigned int gbc_readFingerprint()
+{
+	int i;
+	
+	//wake up cartridge with a few reads (some seem to need it)
+	char header[0x1C];
+	gbc_rom_readAt(header, 0x00, 4);
+	
+	//read just the title through global checksum area of the header
+	gbc_rom_readAt(header, 0x134, 0x1C);
+	
+	//power down the cart slot
+	gbc_cart_powerDown();
+	
+	//verify header checksum
+	unsigned char chk=0;
+	for(i=0x00; i<0x19; i++) chk = chk - header[i];
+	chk = chk - 0x19;
+	if(header[0x19] != chk) return 0;
+	
+	//fnv-1a hash of the header area
+	unsigned int hash = 2166136261u;
+	for(i=0x00; i<0x1C; i++) hash = (hash ^ (unsigned char)header[i]) * 16777619u;
+	if(hash == 0) hash = 1;
+	return hash;
+}
+
 // Dumps the first 400 bytes of the connected GB cartridge
 void gbc_dumpHeader(char* data)
 {
@@ -51,12 +51,18 @@ unsigned int gbc_getSaveSize();
 // Read the ROM of a connected GB cartridge and returns the size
 int gbc_readROM(char* buffer, unsigned int length);
 
+// Read a single 16K bank of the ROM of a connected GB cartridge and returns the size
+int gbc_readROMBank(char* buffer, unsigned int bank);
+
 // Read the Save Data of a connected GB cartridge and returns the size
 int gbc_readSave(char* buffer, unsigned int length);
 
 // Write the Save Data to a connected GB cartridge
 int gbc_writeSave(char* buffer, unsigned int length);
 
+// Reads a cheap fingerprint of the connected GB cartridge header (0 if no valid header)
+unsigned int gbc_readFingerprint();
+
 // Dumps the first 400 bytes of the connected GB cartridge
 void gbc_dumpHeader(char* data);
 
@@ -37,6 +37,32 @@ unsigned int gbc_mbc1_readROM(char* buffer, unsigned int length)
 	return length;
 }
 
+// Read a single 16K ROM bank for MBC1 Memory Controller
+unsigned int gbc_mbc1_readROMBank(char* buffer, unsigned int bank)
+{
+	//bank 0 is always mapped
+	if(bank == 0) {
+		gbc_rom_readAt(buffer, 0x00, GBC_16K);
+		return GBC_16K;
+	}
+	
+	//set to ROM banking mode
+	gbc_rom_writeByte(0x00, 0x6000);
+	
+	//set bank
+	char bankNum0 = (char) (bank & 0x1F);
+	char bankNum1 = (char) ((bank >> 5) & 0x03);
+	gbc_rom_writeByte(bankNum0, 0x2000);
+	gbc_rom_writeByte(bankNum1, 0x4000);
+	gbc_rom_readAt(buffer, GBC_16K, GBC_16K);
+	
+	//set back to bank 1
+	gbc_rom_writeByte(0x01, 0x2000);
+	gbc_rom_writeByte(0x00, 0x4000);
+	
+	return GBC_16K;
+}
+
 // Read RAM for MBC1 Memory Controller
 unsigned int gbc_mbc1_readRAM(char* buffer, unsigned int length)
 {
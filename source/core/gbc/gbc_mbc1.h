@@ -4,6 +4,9 @@
 // Read ROM for MBC1 Memory Controller
 unsigned int gbc_mbc1_readROM(char* buffer, unsigned int length);
 
+// Read a single 16K ROM bank for MBC1 Memory Controller
+unsigned int gbc_mbc1_readROMBank(char* buffer, unsigned int bank);
+
 // Read RAM for MBC1 Memory Controller
 unsigned int gbc_mbc1_readRAM(char* buffer, unsigned int length);
 
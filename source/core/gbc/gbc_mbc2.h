@@ -4,4 +4,7 @@
 // Read ROM for MBC2 Memory Controller
 unsigned int gbc_mbc2_readROM(char* buffer, unsigned int length);
 
+// Read a single 16K ROM bank for MBC2 Memory Controller
+unsigned int gbc_mbc2_readROMBank(char* buffer, unsigned int bank);
+
 #endif /* GBC_MBC2_H */
@@ -31,6 +31,26 @@ unsigned int gbc_mbc3_readROM(char* buffer, unsigned int length)
 	return length;
 }
 
+// Read a single 16K ROM bank for MBC3 Memory Controller
+unsigned int gbc_mbc3_readROMBank(char* buffer, unsigned int bank)
+{
+	//bank 0 is always mapped
+	if(bank == 0) {
+		gbc_rom_readAt(buffer, 0x00, GBC_16K);
+		return GBC_16K;
+	}
+	
+	//set bank
+	char bankNum0 = (char) (bank & 0x7F);
+	gbc_rom_writeByte(bankNum0, 0x2000);
+	gbc_rom_readAt(buffer, GBC_16K, GBC_16K);
+	
+	//set back to bank 1
+	gbc_rom_writeByte(0x01, 0x2000);
+	
+	return GBC_16K;
+}
+
 // Read RAM for MBC3 Memory Controller
 unsigned int gbc_mbc3_readRAM(char* buffer, unsigned int length)
 {
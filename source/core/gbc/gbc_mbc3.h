@@ -4,6 +4,9 @@
 // Read ROM for MBC3 Memory Controller
 unsigned int gbc_mbc3_readROM(char* buffer, unsigned int length);
 
+// Read a single 16K ROM bank for MBC3 Memory Controller
+unsigned int gbc_mbc3_readROMBank(char* buffer, unsigned int bank);
+
 // Read RAM for MBC3 Memory Controller
 unsigned int gbc_mbc3_readRAM(char* buffer, unsigned int length);
 
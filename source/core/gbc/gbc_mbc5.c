@@ -34,6 +34,29 @@ unsigned int gbc_mbc5_readROM(char* buffer, unsigned int length)
 	return length;
 }
 
+// Read a single 16K ROM bank for MBC5 Memory Controller
+unsigned int gbc_mbc5_readROMBank(char* buffer, unsigned int bank)
+{
+	//bank 0 is always mapped
+	if(bank == 0) {
+		gbc_rom_readAt(buffer, 0x00, GBC_16K);
+		return GBC_16K;
+	}
+	
+	//set bank
+	char bankNum0 = (char) bank;
+	char bankNum1 = (char) (bank >> 8);
+	gbc_rom_writeByte(bankNum1, 0x3000);
+	gbc_rom_writeByte(bankNum0, 0x2000);
+	gbc_rom_readAt(buffer, GBC_16K, GBC_16K);
+	
+	//set back to bank 1
+	gbc_rom_writeByte(0x00, 0x3000);
+	gbc_rom_writeByte(0x01, 0x2000);
+	
+	return GBC_16K;
+}
+
 // Read RAM for MBC5 Memory Controller
 unsigned int gbc_mbc5_readRAM(char* buffer, unsigned int length)
 {
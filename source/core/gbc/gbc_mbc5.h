@@ -4,6 +4,9 @@
 // Read ROM for MBC5 Memory Controller
 unsigned int gbc_mbc5_readROM(char* buffer, unsigned int length);
 
+// Read a single 16K ROM bank for MBC5 Memory Controller
+unsigned int gbc_mbc5_readROMBank(char* buffer, unsigned int bank);
+
 // Read RAM for MBC5 Memory Controller
 unsigned int gbc_mbc5_readRAM(char* buffer, unsigned int length);
 
@@ -1,21 +1,88 @@
 #include "gbx.h"
 #include "gbc/gbc.h"
+#include "gbc/gbc_rom.h"
 #include "gba/gba.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
 #include "egpio.h"
 #include "spi.h"
 
 #define GBX_DTSW 0x40
 #define GBX_SPI_KEY 0xC42C4865
 
+#define GBX_JOB_TYPE_READ_ROM 0
+#define GBX_JOB_TYPE_READ_SAVE 1
+#define GBX_JOB_TYPE_WRITE_SAVE 2
+#define GBX_JOB_TYPE_STAGE_ROM 3
+
+#define GBX_STAGE_YIELD_MILLIS 50
+
+#define GBX_MONITOR_SWITCH_MILLIS 250
+#define GBX_MONITOR_FINGERPRINT_MILLIS 2000
+#define GBX_EVENT_QUEUE_SIZE 16
+
+#define GBX_TIMING_OP_READ_ROM 0
+#define GBX_TIMING_OP_READ_SAVE 1
+#define GBX_TIMING_OP_WRITE_SAVE 2
+#define GBX_TIMING_NUM_OPS 3
+#define GBX_TIMING_NUM_KINDS 16
+#define GBX_TIMING_WEIGHT 0.5
+
+typedef struct {
+	pthread_t threadId;
+	char type;
+	char* data;
+	unsigned int total;
+	unsigned int firstChunk;
+	unsigned int pending;
+	unsigned int fingerprint;
+	long fingerprintMillis;
+	char changed;
+	volatile unsigned int transferred;
+	volatile char cancel;
+	volatile char done;
+	int result;
+} gbx_jobData;
+
 // Data
 static char gbx_isInitFlag = 0;
+static gbx_jobData* gbx_activeJob = 0;
+static double gbx_timingRates[GBX_TIMING_NUM_OPS][GBX_TIMING_NUM_KINDS];
+static char gbx_timingFilename[256] = {0};
+static pthread_mutex_t gbx_mutex;
+static int gbx_lockDepth = 0;
+static pthread_t gbx_monitorThreadId;
+static volatile char gbx_monitorRunning = 0;
+static unsigned int gbx_monitorFingerprint = 0;
+static pthread_mutex_t gbx_eventMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t gbx_jobMutex = PTHREAD_MUTEX_INITIALIZER;
+static char gbx_eventQueue[GBX_EVENT_QUEUE_SIZE];
+static int gbx_eventHead = 0;
+static int gbx_eventCount = 0;
 
 // Helper functions
+static void gbx_lock();
+static void gbx_unlock();
+static void* gbx_thread_monitor(void* args);
+static unsigned int gbx_checkFingerprint();
+static void gbx_postEvent(char event);
 static char gbx_isGB();
 static char gbx_isLoaded_noLock();
+static gbx_job* gbx_startJob(char type, char* data, unsigned int total, unsigned int firstChunk);
+static void* gbx_thread_job(void* args);
+static int gbx_jobCopyChunk(char* chunk, unsigned int chunkIndex, unsigned int length, void* param);
+static int gbx_jobStageChunk(char* chunk, unsigned int chunkIndex, unsigned int length, void* param);
+static void gbx_jobSetTransferred(gbx_jobData* jobData, unsigned int transferred);
+static int gbx_timingKind();
+static unsigned int gbx_timingEstimate(unsigned char op, unsigned int length);
+static void gbx_timingRecord(unsigned char op, unsigned int length, long startMillis);
+
+// Util functions
+static long gbx_millis();
+static void gbx_sleep(long millis);
 
 // Setup and initialize the GBx utils
 int gbx_init()
@@ -23,6 +90,13 @@ int gbx_init()
 	//already initialized?
 	if(gbx_isInitFlag == 1) return 0;
 	
+	//recursive lock so gbx calls can nest
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&gbx_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	
 	//init and check dependencies
 	gbc_init();
 	gba_init();
@@ -47,7 +121,7 @@ int gbx_isInit()
 char gbx_loadHeader()
 {
 	char result = 0;
-	spi_obtainLock(GBX_SPI_KEY, 0);
+	gbx_lock();
 	
 	if(gbx_isGB()) {
 		gba_loadClear();
@@ -57,7 +131,7 @@ char gbx_loadHeader()
 		result = gba_loadHeader();
 	}
 	
-	spi_unlock(GBX_SPI_KEY);
+	gbx_unlock();
 	return result;
 }
 
@@ -65,9 +139,9 @@ char gbx_loadHeader()
 char gbx_isLoaded()
 {
 	char result = 0;
-	spi_obtainLock(GBX_SPI_KEY, 0);
+	gbx_lock();
 	result = gbx_isLoaded_noLock();
-	spi_unlock(GBX_SPI_KEY);
+	gbx_unlock();
 	return result;
 }
 
@@ -152,9 +226,37 @@ unsigned int gbx_getSaveSize()
 	return gbc_getSaveSize();
 }
 
+// Gets the memory controller (GB) or save type (GBA) of the connected GBx cartridge
+char gbx_getMemoryType()
+{
+	if(gba_getROMSize() > 0) {
+		return gba_getSaveType();
+	}
+	return gbc_getMemoryController();
+}
+
+// Loads the measured transfer rates from the given file and keeps it updated after each transfer
+void gbx_loadTimingModel(const char* filename)
+{
+	int op, kind;
+	double rate;
+	
+	strncpy(gbx_timingFilename, filename, 255);
+	FILE* file = fopen(filename, "r");
+	if(file == NULL) return;
+	while(fscanf(file, "%d %d %lf", &op, &kind, &rate) == 3) {
+		if(op >= 0 && op < GBX_TIMING_NUM_OPS && kind >= 0 && kind < GBX_TIMING_NUM_KINDS && rate > 0) gbx_timingRates[op][kind] = rate;
+	}
+	fclose(file);
+}
+
 // Gets the estimated amount of time to read GBx cartridge ROM (millis)
 unsigned int gbx_timeToReadROM()
 {
+	unsigned int estimate = gbx_timingEstimate(GBX_TIMING_OP_READ_ROM, gbx_getROMSize());
+	if(estimate > 0) return estimate;
+	
+	//nothing measured yet
 	if(gba_getROMSize() > 0) {
 		return ((gba_getROMSize()/100)*1405)/10000; //0.0014050436
 	}
@@ -164,6 +266,10 @@ unsigned int gbx_timeToReadROM()
 // Gets the estimated amount of time to read GBx cartridge Save (millis)
 unsigned int gbx_timeToReadSave()
 {
+	unsigned int estimate = gbx_timingEstimate(GBX_TIMING_OP_READ_SAVE, gbx_getSaveSize());
+	if(estimate > 0) return estimate;
+	
+	//nothing measured yet
 	if(gba_getROMSize() > 0) {
 		if(gba_getSaveType()==GBA_SAVE_TYPE_EEPROM_4K) return 53;
 		if(gba_getSaveType()==GBA_SAVE_TYPE_EEPROM_64K) return 946;
@@ -179,6 +285,10 @@ unsigned int gbx_timeToReadSave()
 // Gets the estimated amount of time to write GBx cartridge Save (millis)
 unsigned int gbx_timeToWriteSave()
 {
+	unsigned int estimate = gbx_timingEstimate(GBX_TIMING_OP_WRITE_SAVE, gbx_getSaveSize());
+	if(estimate > 0) return estimate;
+	
+	//nothing measured yet
 	if(gba_getROMSize() > 0) {
 		if(gba_getSaveType()==GBA_SAVE_TYPE_EEPROM_4K) return 541;
 		if(gba_getSaveType()==GBA_SAVE_TYPE_EEPROM_64K) return 13289;
@@ -194,7 +304,8 @@ unsigned int gbx_timeToWriteSave()
 // Read the ROM of the connected GBx cartridge
 int gbx_readROM(char* data)
 {
-	spi_obtainLock(GBX_SPI_KEY, 0);
+	gbx_lock();
+	long start = gbx_millis();
 	
 	int result = GBX_ERROR_NO_CARTRIDGE;
 	if(gba_getROMSize() > 0) {
@@ -203,15 +314,104 @@ int gbx_readROM(char* data)
 	else if(gbc_getROMSize() > 0) {
 		result = gbc_readROM(data, gbc_getROMSize());
 	}
+	if(result > 0) gbx_timingRecord(GBX_TIMING_OP_READ_ROM, result, start);
+	
+	gbx_unlock();
+	return result;
+}
+
+// Read the ROM of the connected GBx cartridge in chunks starting at the given chunk (returns the next chunk index)
+int gbx_readROMChunks(unsigned int firstChunk, gbx_chunkHandler handler, void* param)
+{
+	gbx_lock();
+	long start = gbx_millis();
+	
+	int result = GBX_ERROR_NO_CARTRIDGE;
+	if(gba_getROMSize() > 0) {
+		result = gba_readROMChunks(firstChunk, handler, param);
+	}
+	else if(gbc_getROMSize() > 0) {
+		//gb chunks are filled a whole bank at a time
+		unsigned int romSize = gbc_getROMSize();
+		char* chunk = (char*)malloc(GBX_CHUNK_SIZE);
+		if(chunk == 0) {
+			gbx_unlock();
+			return GBX_ERROR_NO_CARTRIDGE;
+		}
+		unsigned int chunkIndex = firstChunk;
+		result = chunkIndex;
+		while(chunkIndex * GBX_CHUNK_SIZE < romSize) {
+			unsigned int chunkStart = chunkIndex * GBX_CHUNK_SIZE;
+			unsigned int chunkLength = GBX_CHUNK_SIZE;
+			if(chunkStart + chunkLength > romSize) chunkLength = romSize - chunkStart;
+			unsigned int offset;
+			for(offset = 0; offset < chunkLength; offset += GBC_16K) {
+				int bankResult = gbc_readROMBank(chunk + offset, (chunkStart + offset) / GBC_16K);
+				if(bankResult < GBC_16K) {
+					result = (bankResult < 0) ? bankResult : GBX_ERROR_NO_CARTRIDGE;
+					break;
+				}
+			}
+			if(offset < chunkLength) break;
+			chunkIndex++;
+			result = chunkIndex;
+			if(handler(chunk, chunkIndex - 1, chunkLength, param) != 0) break;
+		}
+		free(chunk);
+	}
+	
+	//only full reads count towards the rate (handlers may stop early or do slow work)
+	if(firstChunk == 0 && result > 0 && (unsigned int)result * GBX_CHUNK_SIZE >= gbx_getROMSize()) gbx_timingRecord(GBX_TIMING_OP_READ_ROM, gbx_getROMSize(), start);
+	
+	gbx_unlock();
+	return result;
+}
+
+// Read part of the ROM of the connected GBx cartridge at the given start
+int gbx_readROMAt(char* data, unsigned int start, unsigned int length)
+{
+	gbx_lock();
+	
+	int result = GBX_ERROR_NO_CARTRIDGE;
+	if(gba_getROMSize() > 0) {
+		result = gba_readROMAt(data, start, length);
+	}
+	else if(gbc_getROMSize() > 0) {
+		//gb carts are read a whole bank at a time
+		char* bankData = (char*)malloc(GBC_16K);
+		if(bankData == 0) {
+			gbx_unlock();
+			return GBX_ERROR_NO_CARTRIDGE;
+		}
+		unsigned int offset = 0;
+		if(start >= gbc_getROMSize()) length = 0;
+		else if(start + length > gbc_getROMSize()) length = gbc_getROMSize() - start;
+		result = length;
+		while(offset < length) {
+			unsigned int address = start + offset;
+			unsigned int bankOffset = address % GBC_16K;
+			unsigned int copyLength = GBC_16K - bankOffset;
+			if(copyLength > length - offset) copyLength = length - offset;
+			int bankResult = gbc_readROMBank(bankData, address / GBC_16K);
+			if(bankResult < GBC_16K) {
+				result = (bankResult < 0) ? bankResult : GBX_ERROR_NO_CARTRIDGE;
+				break;
+			}
+			memcpy(data + offset, bankData + bankOffset, copyLength);
+			offset += copyLength;
+		}
+		free(bankData);
+	}
 	
-	spi_unlock(GBX_SPI_KEY);
+	gbx_unlock();
 	return result;
 }
 
 // Read the Save Data of the connected GBx cartridge
 int gbx_readSave(char* data)
 {
-	spi_obtainLock(GBX_SPI_KEY, 0);
+	gbx_lock();
+	long start = gbx_millis();
 	
 	int result = GBX_ERROR_NO_CARTRIDGE;
 	if(gba_getSaveSize() > 0) {
@@ -220,68 +420,246 @@ int gbx_readSave(char* data)
 	else if(gbc_getSaveSize() > 0) {
 		result = gbc_readSave(data, gbc_getSaveSize());
 	}
+	if(result > 0) gbx_timingRecord(GBX_TIMING_OP_READ_SAVE, result, start);
 	
-	spi_unlock(GBX_SPI_KEY);
+	gbx_unlock();
+	return result;
+}
+
+// Read the Save Data of the connected GBx cartridge in blocks of the given size and order (returns the number of blocks handled)
+int gbx_readSaveBlocks(unsigned int blockSize, unsigned int* order, unsigned int count, gbx_chunkHandler handler, void* param)
+{
+	gbx_lock();
+	
+	int result = GBX_ERROR_NO_CARTRIDGE;
+	if(gba_getSaveSize() > 0) {
+		result = gba_readSaveBlocks(blockSize, order, count, handler, param);
+	}
+	else if(gbc_getSaveSize() > 0) {
+		//gb saves are small enough to read whole and hand out in blocks
+		unsigned int saveSize = gbc_getSaveSize();
+		char* save = (char*)malloc(saveSize);
+		if(save == 0) {
+			gbx_unlock();
+			return GBX_ERROR_NO_CARTRIDGE;
+		}
+		result = gbc_readSave(save, saveSize);
+		if(result > 0) {
+			unsigned int i;
+			for(i = 0; i < count; i++) {
+				unsigned int start = order[i] * blockSize;
+				if(start >= (unsigned int)result) continue;
+				unsigned int length = blockSize;
+				if(start + length > (unsigned int)result) length = result - start;
+				if(handler(save + start, order[i], length, param) != 0) {
+					i++;
+					break;
+				}
+			}
+			result = i;
+		}
+		free(save);
+	}
+	
+	gbx_unlock();
 	return result;
 }
 
 // Write the Save Data to the connected GBx cartridge
 int gbx_writeSave(char* data)
 {
-	spi_obtainLock(GBX_SPI_KEY, 0);
+	gbx_lock();
 
 	//double check that the believed loaded cartridge is correct
 	if(gbx_getROMSize() == 0) {
-		spi_unlock(GBX_SPI_KEY);
+		gbx_unlock();
 		return GBX_ERROR_CARTRIDGE_NOT_LOADED;
 	}
 	if(gbx_isLoaded_noLock() == 0) {
 		gbx_loadHeader();
 		
-		spi_unlock(GBX_SPI_KEY);
+		gbx_unlock();
 		if(gbx_getROMSize() > 0) return GBX_ERROR_CARTRIDGE_CHANGED;
 		return GBX_ERROR_NO_CARTRIDGE;
 	}
 
 	//write data
+	long start = gbx_millis();
 	int result = GBX_ERROR_NO_CARTRIDGE;
 	if(gba_getSaveSize() > 0) {
 		result = gba_writeSave(data, gba_getSaveSize());
+		if(result == GBA_ERROR_WRITE_FAILED) result = GBX_ERROR_WRITE_FAILED;
 	}
 	else if(gbc_getSaveSize() > 0) {
 		result = gbc_writeSave(data, gbc_getSaveSize());
 	}
+	if(result > 0) gbx_timingRecord(GBX_TIMING_OP_WRITE_SAVE, result, start);
+	
+	gbx_unlock();
+	return result;
+}
+
+// Starts reading the ROM of the connected GBx cartridge on a worker thread (null if a job is already running)
+gbx_job* gbx_startReadROM(char* data)
+{
+	return gbx_startJob(GBX_JOB_TYPE_READ_ROM, data, gbx_getROMSize(), 0);
+}
+
+// Starts reading the ROM from the given chunk on a worker thread, leaving earlier chunks of data untouched (null if a job is already running)
+gbx_job* gbx_startReadROMFrom(char* data, unsigned int firstChunk)
+{
+	return gbx_startJob(GBX_JOB_TYPE_READ_ROM, data, gbx_getROMSize(), firstChunk);
+}
+
+// Starts a low priority ROM read from the given chunk that yields the bus between chunks and stops if the cartridge changes (null if a job is already running)
+gbx_job* gbx_startStageROM(char* data, unsigned int firstChunk)
+{
+	return gbx_startJob(GBX_JOB_TYPE_STAGE_ROM, data, gbx_getROMSize(), firstChunk);
+}
+
+// Starts reading the Save Data of the connected GBx cartridge on a worker thread (null if a job is already running)
+gbx_job* gbx_startReadSave(char* data)
+{
+	return gbx_startJob(GBX_JOB_TYPE_READ_SAVE, data, gbx_getSaveSize(), 0);
+}
+
+// Starts writing the Save Data to the connected GBx cartridge on a worker thread (null if a job is already running)
+gbx_job* gbx_startWriteSave(char* data)
+{
+	return gbx_startJob(GBX_JOB_TYPE_WRITE_SAVE, data, gbx_getSaveSize(), 0);
+}
+
+// Gets the fraction of bytes actually transferred by the given job (0.0 to 1.0)
+float gbx_jobProgress(gbx_job* job)
+{
+	gbx_jobData* jobData = (gbx_jobData*)job;
+	if(jobData == 0 || jobData->total == 0) return 1.0f;
+	return (float)gbx_jobTransferred(job) / (float)jobData->total;
+}
+
+// Gets the number of bytes the given job has transferred so far
+unsigned int gbx_jobTransferred(gbx_job* job)
+{
+	gbx_jobData* jobData = (gbx_jobData*)job;
+	if(jobData == 0) return 0;
+	
+	pthread_mutex_lock(&gbx_jobMutex);
+	unsigned int transferred = jobData->transferred;
+	pthread_mutex_unlock(&gbx_jobMutex);
+	return transferred;
+}
+
+// Checks if the given job has finished
+char gbx_jobIsDone(gbx_job* job)
+{
+	gbx_jobData* jobData = (gbx_jobData*)job;
+	if(jobData == 0) return 1;
+	return jobData->done;
+}
+
+// Requests the given job to stop at the next chunk boundary
+void gbx_jobCancel(gbx_job* job)
+{
+	gbx_jobData* jobData = (gbx_jobData*)job;
+	if(jobData != 0) jobData->cancel = 1;
+}
+
+// Waits for the given job to finish, frees it and returns its result
+int gbx_jobWait(gbx_job* job)
+{
+	gbx_jobData* jobData = (gbx_jobData*)job;
+	if(jobData == 0) return GBX_ERROR_BUSY;
 	
-	spi_unlock(GBX_SPI_KEY);
+	pthread_join(jobData->threadId, NULL);
+	int result = jobData->result;
+	gbx_lock();
+	if(gbx_activeJob == jobData) gbx_activeJob = 0;
+	gbx_unlock();
+	free(jobData);
 	return result;
 }
 
+// Reads a fingerprint of the connected cartridge header without loading it (0 if no valid header)
+unsigned int gbx_readFingerprint()
+{
+	unsigned int fingerprint = 0;
+	gbx_lock();
+	
+	if(gbx_isGB()) fingerprint = gbc_readFingerprint();
+	else fingerprint = gba_readFingerprint();
+	
+	gbx_unlock();
+	return fingerprint;
+}
+
+// Starts the background cartridge monitor
+int gbx_startMonitor()
+{
+	if(gbx_monitorRunning) return 0;
+	
+	gbx_lock();
+	gbx_monitorFingerprint = gbx_readFingerprint();
+	gbx_unlock();
+	
+	gbx_monitorRunning = 1;
+	if(pthread_create(&gbx_monitorThreadId, NULL, gbx_thread_monitor, NULL) > 0) {
+		gbx_monitorRunning = 0;
+		return 1;
+	}
+	return 0;
+}
+
+// Stops the background cartridge monitor
+void gbx_stopMonitor()
+{
+	if(gbx_monitorRunning == 0) return;
+	
+	gbx_monitorRunning = 0;
+	pthread_join(gbx_monitorThreadId, NULL);
+}
+
+// Gets the next cartridge event posted by the monitor (GBX_EVENT_NONE if empty)
+char gbx_pollEvent()
+{
+	char event = GBX_EVENT_NONE;
+	pthread_mutex_lock(&gbx_eventMutex);
+	if(gbx_eventCount > 0) {
+		event = gbx_eventQueue[gbx_eventHead];
+		gbx_eventHead = (gbx_eventHead + 1) % GBX_EVENT_QUEUE_SIZE;
+		gbx_eventCount--;
+	}
+	pthread_mutex_unlock(&gbx_eventMutex);
+	return event;
+}
+
 // Checks the state of the cartridge detector switch
 char gbx_checkDetectorSwitch()
 {
 	char result = 0;
-	spi_obtainLock(GBX_SPI_KEY, 0);
+	gbx_lock();
 	
 	if(gbx_isGB()) result = 1;
 	
-	spi_unlock(GBX_SPI_KEY);
+	gbx_unlock();
 	return result;
 }
 
 // Dumps the first 400 bytes of the connected GBx cartridge
 void gbx_dumpHeader(char* data)
 {
-	spi_obtainLock(GBX_SPI_KEY, 0);
+	gbx_lock();
 	
 	if(gbx_isGB()) gbc_dumpHeader(data);
 	else gba_dumpHeader(data);
 	
-	spi_unlock(GBX_SPI_KEY);
+	gbx_unlock();
 }
 
 // Cleans up the GBx utils
 int gbx_close()
 {
+	gbx_stopMonitor();
+	
 	//close dependencies
 	gbc_close();
 	gba_close();
@@ -290,6 +668,70 @@ int gbx_close()
 	return 0;
 }
 
+// Locks the cartridge bus for the calling thread
+static void gbx_lock() {
+	pthread_mutex_lock(&gbx_mutex);
+	if(gbx_lockDepth++ == 0) spi_obtainLock(GBX_SPI_KEY, 0);
+}
+
+// Unlocks the cartridge bus
+static void gbx_unlock() {
+	if(--gbx_lockDepth == 0) spi_unlock(GBX_SPI_KEY);
+	pthread_mutex_unlock(&gbx_mutex);
+}
+
+// Cartridge monitor thread
+static void* gbx_thread_monitor(void* args) {
+	char lastSwitch = gbx_checkDetectorSwitch();
+	long elapsed = 0;
+	(void)args;
+	
+	while(gbx_monitorRunning) {
+		gbx_sleep(GBX_MONITOR_SWITCH_MILLIS);
+		elapsed += GBX_MONITOR_SWITCH_MILLIS;
+		
+		//the detector switch is cheap, the header fingerprint only gets read on a switch change or every so often
+		char detectorSwitch = gbx_checkDetectorSwitch();
+		if(detectorSwitch == lastSwitch && elapsed < GBX_MONITOR_FINGERPRINT_MILLIS) continue;
+		lastSwitch = detectorSwitch;
+		elapsed = 0;
+		
+		//a running rom transfer checks the fingerprint between its own chunks
+		gbx_lock();
+		if(gbx_activeJob == 0) gbx_checkFingerprint();
+		gbx_unlock();
+	}
+	return 0;
+}
+
+// Reads the cartridge fingerprint and posts an event if it differs from the last one seen
+static unsigned int gbx_checkFingerprint() {
+	//note: the header itself is left for the main thread to load when it handles the event
+	gbx_lock();
+	unsigned int fingerprint = gbx_readFingerprint();
+	if(fingerprint != gbx_monitorFingerprint) {
+		char event = GBX_EVENT_CHANGED;
+		if(gbx_monitorFingerprint == 0) event = GBX_EVENT_INSERTED;
+		else if(fingerprint == 0) event = GBX_EVENT_REMOVED;
+		gbx_monitorFingerprint = fingerprint;
+		gbx_postEvent(event);
+	}
+	gbx_unlock();
+	return fingerprint;
+}
+
+// Adds an event to the queue (oldest event is dropped when full)
+static void gbx_postEvent(char event) {
+	pthread_mutex_lock(&gbx_eventMutex);
+	if(gbx_eventCount == GBX_EVENT_QUEUE_SIZE) {
+		gbx_eventHead = (gbx_eventHead + 1) % GBX_EVENT_QUEUE_SIZE;
+		gbx_eventCount--;
+	}
+	gbx_eventQueue[(gbx_eventHead + gbx_eventCount) % GBX_EVENT_QUEUE_SIZE] = event;
+	gbx_eventCount++;
+	pthread_mutex_unlock(&gbx_eventMutex);
+}
+
 // Checks for the GB cartridge detector switch
 static char gbx_isGB() {
 	char state = egpio_readPort(EX_GPIO_PORTD);
@@ -308,3 +750,177 @@ static char gbx_isLoaded_noLock() {
 	}
 	return 0;
 }
+
+// Creates a job and starts its worker thread
+static gbx_job* gbx_startJob(char type, char* data, unsigned int total, unsigned int firstChunk) {
+	//the check and the claim happen under the lock so only one caller gets the job slot
+	gbx_lock();
+	if(gbx_activeJob != 0) {
+		gbx_unlock();
+		return 0;
+	}
+	
+	gbx_jobData* jobData = (gbx_jobData*)malloc(sizeof(gbx_jobData));
+	if(jobData == 0) {
+		gbx_unlock();
+		return 0;
+	}
+	jobData->type = type;
+	jobData->data = data;
+	jobData->total = total;
+	jobData->firstChunk = firstChunk;
+	jobData->pending = 0;
+	jobData->transferred = firstChunk * GBX_CHUNK_SIZE;
+	if(jobData->transferred > total) jobData->transferred = total;
+	jobData->fingerprint = 0;
+	jobData->fingerprintMillis = 0;
+	jobData->changed = 0;
+	jobData->cancel = 0;
+	jobData->done = 0;
+	jobData->result = GBX_ERROR_NO_CARTRIDGE;
+	
+	gbx_activeJob = jobData;
+	if(pthread_create(&jobData->threadId, NULL, gbx_thread_job, (void*)jobData) > 0) {
+		gbx_activeJob = 0;
+		gbx_unlock();
+		free(jobData);
+		return 0;
+	}
+	gbx_unlock();
+	return (gbx_job*)jobData;
+}
+
+// Job worker thread
+static void* gbx_thread_job(void* args) {
+	gbx_jobData* jobData = (gbx_jobData*)args;
+	
+	if(jobData->cancel) {
+		jobData->result = GBX_ERROR_CANCELLED;
+	} else if(jobData->type == GBX_JOB_TYPE_READ_ROM) {
+		//rom is read in chunks so progress, cancellation and hot-plug checks work between them
+		int next = 0;
+		jobData->fingerprint = gbx_checkFingerprint();
+		jobData->fingerprintMillis = gbx_millis();
+		if(jobData->transferred < jobData->total) next = gbx_readROMChunks(jobData->firstChunk, gbx_jobCopyChunk, jobData);
+		if(next < 0) jobData->result = next;
+		else if(jobData->changed) jobData->result = GBX_ERROR_CARTRIDGE_CHANGED;
+		else if(jobData->transferred < jobData->total) jobData->result = GBX_ERROR_CANCELLED;
+		else jobData->result = jobData->transferred;
+	} else if(jobData->type == GBX_JOB_TYPE_STAGE_ROM) {
+		//chunks only count once the same cartridge is confirmed still connected after reading them
+		unsigned int fingerprint = gbx_checkFingerprint();
+		int next = jobData->firstChunk;
+		jobData->result = jobData->transferred;
+		while(jobData->transferred < jobData->total && jobData->cancel == 0) {
+			next = gbx_readROMChunks(next, gbx_jobStageChunk, jobData);
+			if(next < 0) {
+				jobData->result = next;
+				break;
+			}
+			if(fingerprint == 0 || gbx_checkFingerprint() != fingerprint) {
+				jobData->result = GBX_ERROR_CARTRIDGE_CHANGED;
+				break;
+			}
+			gbx_jobSetTransferred(jobData, jobData->pending);
+			jobData->result = jobData->transferred;
+			
+			//give other bus users a turn
+			gbx_sleep(GBX_STAGE_YIELD_MILLIS);
+		}
+		if(jobData->result >= 0 && jobData->transferred < jobData->total) jobData->result = GBX_ERROR_CANCELLED;
+	} else {
+		//save transfers are short and must not be interrupted part way
+		if(jobData->type == GBX_JOB_TYPE_READ_SAVE) jobData->result = gbx_readSave(jobData->data);
+		else jobData->result = gbx_writeSave(jobData->data);
+		if(jobData->result > 0) gbx_jobSetTransferred(jobData, jobData->result);
+	}
+	
+	//gba/gbc calls leave the cart slot powered down once they return
+	jobData->done = 1;
+	return 0;
+}
+
+// Copies a chunk into the job data and reports progress (stops early if the cartridge changed)
+static int gbx_jobCopyChunk(char* chunk, unsigned int chunkIndex, unsigned int length, void* param) {
+	gbx_jobData* jobData = (gbx_jobData*)param;
+	memcpy(jobData->data + (chunkIndex * GBX_CHUNK_SIZE), chunk, length);
+	gbx_jobSetTransferred(jobData, (chunkIndex * GBX_CHUNK_SIZE) + length);
+	
+	//the monitor leaves the bus to the job, so the fingerprint is checked here every so often
+	if(gbx_millis() - jobData->fingerprintMillis >= GBX_MONITOR_FINGERPRINT_MILLIS) {
+		jobData->fingerprintMillis = gbx_millis();
+		if(gbx_checkFingerprint() != jobData->fingerprint) {
+			jobData->changed = 1;
+			return 1;
+		}
+	}
+	return jobData->cancel;
+}
+
+// Copies a chunk into the job data without reporting it yet (gba reads stop after every chunk to free the bus)
+static int gbx_jobStageChunk(char* chunk, unsigned int chunkIndex, unsigned int length, void* param) {
+	gbx_jobData* jobData = (gbx_jobData*)param;
+	memcpy(jobData->data + (chunkIndex * GBX_CHUNK_SIZE), chunk, length);
+	jobData->pending = (chunkIndex * GBX_CHUNK_SIZE) + length;
+	if(gba_getROMSize() > 0) return 1;
+	return jobData->cancel;
+}
+
+// Publishes the transferred byte count (the data below it is final once another thread reads the new count)
+static void gbx_jobSetTransferred(gbx_jobData* jobData, unsigned int transferred) {
+	pthread_mutex_lock(&gbx_jobMutex);
+	jobData->transferred = transferred;
+	pthread_mutex_unlock(&gbx_jobMutex);
+}
+
+// Gets the timing model slot for the loaded cartridge (gba by save type, gb by memory controller)
+static int gbx_timingKind() {
+	if(gba_getROMSize() > 0) return 8 + gba_getSaveType();
+	return gbc_getMemoryController();
+}
+
+// Estimates the time for the given operation from the measured rate (0 if nothing measured yet)
+static unsigned int gbx_timingEstimate(unsigned char op, unsigned int length) {
+	double rate = gbx_timingRates[op][gbx_timingKind()];
+	if(rate <= 0) return 0;
+	return (unsigned int)(length / rate) + 1;
+}
+
+// Records the rate of a completed transfer and saves the model
+static void gbx_timingRecord(unsigned char op, unsigned int length, long startMillis) {
+	int i, j;
+	long duration = gbx_millis() - startMillis;
+	if(duration <= 0) return;
+	
+	//exponentially weighted (first measurement replaces the default)
+	double rate = (double)length / (double)duration;
+	double* current = &gbx_timingRates[op][gbx_timingKind()];
+	if(*current <= 0) *current = rate;
+	else *current = (*current * (1.0 - GBX_TIMING_WEIGHT)) + (rate * GBX_TIMING_WEIGHT);
+	
+	//persist
+	if(gbx_timingFilename[0] == 0) return;
+	FILE* file = fopen(gbx_timingFilename, "w");
+	if(file == NULL) return;
+	for(i = 0; i < GBX_TIMING_NUM_OPS; i++) {
+		for(j = 0; j < GBX_TIMING_NUM_KINDS; j++) {
+			if(gbx_timingRates[i][j] > 0) fprintf(file, "%d %d %f\n", i, j, gbx_timingRates[i][j]);
+		}
+	}
+	fclose(file);
+}
+
+// Gets a monotonic time in milliseconds
+static long gbx_millis() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+// Sleeps for the given number of milliseconds
+static void gbx_sleep(long millis) {
+	struct timespec ts;
+	ts.tv_sec = millis / 1000;
+	ts.tv_nsec = (millis % 1000) * 1000000;
+	nanosleep(&ts, &ts);
+}
@@ -9,6 +9,19 @@
 #define GBX_ERROR_NO_CARTRIDGE -1
 #define GBX_ERROR_CARTRIDGE_CHANGED -2
 #define GBX_ERROR_CARTRIDGE_NOT_LOADED -3
+#define GBX_ERROR_CANCELLED -4
+#define GBX_ERROR_BUSY -5
+#define GBX_ERROR_WRITE_FAILED -6
+
+#define GBX_EVENT_NONE 0
+#define GBX_EVENT_INSERTED 1
+#define GBX_EVENT_REMOVED 2
+#define GBX_EVENT_CHANGED 3
+
+#define GBX_CHUNK_SIZE 131072
+
+typedef void gbx_job;
+typedef int (*gbx_chunkHandler)(char* chunk, unsigned int chunkIndex, unsigned int length, void* param);
 
 // Setup and initialize the GBx utils
 int gbx_init();
@@ -40,6 +53,12 @@ unsigned int gbx_getROMSize();
 // Gets the Save size of the connected GBx cartridge
 unsigned int gbx_getSaveSize();
 
+// Gets the memory controller (GB) or save type (GBA) of the connected GBx cartridge
+char gbx_getMemoryType();
+
+// Loads the measured transfer rates from the given file and keeps it updated after each transfer
+void gbx_loadTimingModel(const char* filename);
+
 // Gets the estimated amount of time to read GBx cartridge ROM (millis)
 unsigned int gbx_timeToReadROM();
 
@@ -52,12 +71,63 @@ unsigned int gbx_timeToWriteSave();
 // Read the ROM of the connected GBx cartridge
 int gbx_readROM(char* data);
 
+// Read the ROM of the connected GBx cartridge in chunks starting at the given chunk (returns the next chunk index)
+int gbx_readROMChunks(unsigned int firstChunk, gbx_chunkHandler handler, void* param);
+
+// Read part of the ROM of the connected GBx cartridge at the given start
+int gbx_readROMAt(char* data, unsigned int start, unsigned int length);
+
 // Read the Save Data of the connected GBx cartridge
 int gbx_readSave(char* data);
 
+// Read the Save Data of the connected GBx cartridge in blocks of the given size and order (returns the number of blocks handled)
+int gbx_readSaveBlocks(unsigned int blockSize, unsigned int* order, unsigned int count, gbx_chunkHandler handler, void* param);
+
 // Write the Save Data to the connected GBx cartridge
 int gbx_writeSave(char* data);
 
+// Starts reading the ROM of the connected GBx cartridge on a worker thread (null if a job is already running)
+gbx_job* gbx_startReadROM(char* data);
+
+// Starts reading the ROM from the given chunk on a worker thread, leaving earlier chunks of data untouched (null if a job is already running)
+gbx_job* gbx_startReadROMFrom(char* data, unsigned int firstChunk);
+
+// Starts a low priority ROM read from the given chunk that yields the bus between chunks and stops if the cartridge changes (null if a job is already running)
+gbx_job* gbx_startStageROM(char* data, unsigned int firstChunk);
+
+// Starts reading the Save Data of the connected GBx cartridge on a worker thread (null if a job is already running)
+gbx_job* gbx_startReadSave(char* data);
+
+// Starts writing the Save Data to the connected GBx cartridge on a worker thread (null if a job is already running)
+gbx_job* gbx_startWriteSave(char* data);
+
+// Gets the fraction of bytes actually transferred by the given job (0.0 to 1.0)
+float gbx_jobProgress(gbx_job* job);
+
+// Gets the number of bytes the given job has transferred so far (data below this count is safe to read)
+unsigned int gbx_jobTransferred(gbx_job* job);
+
+// Checks if the given job has finished
+char gbx_jobIsDone(gbx_job* job);
+
+// Requests the given job to stop at the next chunk boundary
+void gbx_jobCancel(gbx_job* job);
+
+// Waits for the given job to finish, frees it and returns its result
+int gbx_jobWait(gbx_job* job);
+
+// Reads a fingerprint of the connected cartridge header without loading it (0 if no valid header)
+unsigned int gbx_readFingerprint();
+
+// Starts the background cartridge monitor
+int gbx_startMonitor();
+
+// Stops the background cartridge monitor
+void gbx_stopMonitor();
+
+// Gets the next cartridge event posted by the monitor (GBX_EVENT_NONE if empty)
+char gbx_pollEvent();
+
 // Checks the state of the cartridge detector switch
 char gbx_checkDetectorSwitch();
 
@@ -0,0 +1,233 @@
+#include "imx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define IMX_VERSION 1
+#define IMX_MAX_FILENAME_SIZE 256
+
+typedef struct {
+	char magic[4];
+	unsigned int version;
+	long long dirMtime;
+	long long dirMtimeNsec;
+	unsigned int entryCount;
+	unsigned int entriesOffset;
+	unsigned int poolOffset;
+	unsigned int fileSize;
+} imx_fileHeader;
+
+typedef struct {
+	unsigned int key;
+	unsigned int filename;
+} imx_fileEntry;
+
+typedef struct {
+	char* data;
+	unsigned int length;
+	imx_fileHeader* header;
+	imx_fileEntry* entries;
+	char* pool;
+} imx_indexData;
+
+// Constants
+static const char* imx_magic = "IMXI";
+static const char* imx_removedChars = " !@#$%^&*()+-'\\/\"?,<>|:";
+
+// Data
+static const char* imx_sortPool;
+
+// Helper functions
+static imx_indexData* imx_map(const char* indexFilename, struct stat* dirStat);
+static char imx_build(const char* dirPath, const char* indexFilename, struct stat* dirStat);
+static unsigned int imx_addToPool(char** pool, unsigned int* poolSize, unsigned int* poolMax, const char* str);
+static int imx_compareEntries(const void* elem1, const void* elem2);
+
+// Opens the name index of the given image folder, rebuilding it first if missing or out of date (null on failure)
+imx_index* imx_open(const char* dirPath, const char* indexFilename)
+{
+	struct stat dirStat;
+	if(stat(dirPath, &dirStat) != 0) return 0;
+	
+	imx_indexData* indexData = imx_map(indexFilename, &dirStat);
+	if(indexData == 0) {
+		if(imx_build(dirPath, indexFilename, &dirStat) == 0) return 0;
+		indexData = imx_map(indexFilename, &dirStat);
+	}
+	return (imx_index*)indexData;
+}
+
+// Finds the images whose simplified name starts with the given simplified name (returns the number found)
+int imx_find(imx_index* index, const char* simpleName, const char** filenames, int max)
+{
+	imx_indexData* indexData = (imx_indexData*)index;
+	if(indexData == 0 || simpleName == 0) return 0;
+	
+	//binary search for the first key not below the name, matches follow it in order
+	unsigned int length = strlen(simpleName);
+	unsigned int low = 0;
+	unsigned int high = indexData->header->entryCount;
+	while(low < high) {
+		unsigned int mid = low + (high - low) / 2;
+		if(strcmp(indexData->pool + indexData->entries[mid].key, simpleName) < 0) low = mid + 1;
+		else high = mid;
+	}
+	
+	int count = 0;
+	for(; low < indexData->header->entryCount && count < max; low++) {
+		imx_fileEntry* entry = &indexData->entries[low];
+		if(strncmp(indexData->pool + entry->key, simpleName, length) != 0) break;
+		filenames[count++] = indexData->pool + entry->filename;
+	}
+	return count;
+}
+
+// Gets the number of images in the index
+unsigned int imx_getSize(imx_index* index)
+{
+	imx_indexData* indexData = (imx_indexData*)index;
+	if(indexData == 0) return 0;
+	return indexData->header->entryCount;
+}
+
+// Closes the index
+void imx_close(imx_index* index)
+{
+	imx_indexData* indexData = (imx_indexData*)index;
+	if(indexData == 0) return;
+	
+	munmap(indexData->data, indexData->length);
+	free(indexData);
+}
+
+// Simplifies a name for matching (drops punctuation and spaces, ignores case)
+void imx_simplify(char* buffer, const char* str)
+{
+	//single pass with & kept as _
+	char* out = buffer;
+	for(; *str; str++) {
+		char c = *str;
+		if(c == '&') c = '_';
+		else if(strchr(imx_removedChars, c) != 0) continue;
+		else if(c >= 'a' && c <= 'z') c -= 32;
+		*out++ = c;
+	}
+	*out = 0;
+}
+
+// Maps an index file and checks it still matches the folder it was built from
+static imx_indexData* imx_map(const char* indexFilename, struct stat* dirStat) {
+	int fd = open(indexFilename, O_RDONLY);
+	if(fd < 0) return 0;
+	struct stat indexStat;
+	if(fstat(fd, &indexStat) != 0 || indexStat.st_size < (off_t)sizeof(imx_fileHeader)) {
+		close(fd);
+		return 0;
+	}
+	char* data = (char*)mmap(0, indexStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED) return 0;
+	
+	imx_fileHeader* header = (imx_fileHeader*)data;
+	if(memcmp(header->magic, imx_magic, 4) != 0 || header->version != IMX_VERSION || header->fileSize != (unsigned int)indexStat.st_size
+		|| header->dirMtime != (long long)dirStat->st_mtim.tv_sec || header->dirMtimeNsec != (long long)dirStat->st_mtim.tv_nsec) {
+		munmap(data, indexStat.st_size);
+		return 0;
+	}
+	
+	imx_indexData* indexData = (imx_indexData*)malloc(sizeof(imx_indexData));
+	indexData->data = data;
+	indexData->length = indexStat.st_size;
+	indexData->header = header;
+	indexData->entries = (imx_fileEntry*)(data + header->entriesOffset);
+	indexData->pool = data + header->poolOffset;
+	return indexData;
+}
+
+// Lists the image folder and writes out its index sorted by simplified name
+static char imx_build(const char* dirPath, const char* indexFilename, struct stat* dirStat) {
+	DIR* dir = opendir(dirPath);
+	if(dir == NULL) return 0;
+	
+	unsigned int poolSize = 0;
+	unsigned int poolMax = 65536;
+	char* pool = (char*)malloc(poolMax);
+	unsigned int entryCount = 0;
+	unsigned int entryMax = 1024;
+	imx_fileEntry* entries = (imx_fileEntry*)malloc(entryMax * sizeof(imx_fileEntry));
+	
+	struct dirent *dp;
+	char simpleName[IMX_MAX_FILENAME_SIZE];
+	while((dp = readdir(dir)) != NULL) {
+		if((dp->d_type & DT_REG) != DT_REG || strlen(dp->d_name) >= IMX_MAX_FILENAME_SIZE) continue;
+		if(entryCount == entryMax) {
+			entryMax *= 2;
+			entries = (imx_fileEntry*)realloc(entries, entryMax * sizeof(imx_fileEntry));
+		}
+		imx_simplify(simpleName, dp->d_name);
+		entries[entryCount].key = imx_addToPool(&pool, &poolSize, &poolMax, simpleName);
+		entries[entryCount].filename = imx_addToPool(&pool, &poolSize, &poolMax, dp->d_name);
+		entryCount++;
+	}
+	closedir(dir);
+	
+	//sort by simplified name so lookups are a binary search
+	imx_sortPool = pool;
+	qsort(entries, entryCount, sizeof(imx_fileEntry), imx_compareEntries);
+	
+	//write to a temp file then move it into place so readers never map a partial index
+	imx_fileHeader header;
+	memset(&header, 0, sizeof(imx_fileHeader));
+	memcpy(header.magic, imx_magic, 4);
+	header.version = IMX_VERSION;
+	header.dirMtime = dirStat->st_mtim.tv_sec;
+	header.dirMtimeNsec = dirStat->st_mtim.tv_nsec;
+	header.entryCount = entryCount;
+	header.entriesOffset = sizeof(imx_fileHeader);
+	header.poolOffset = header.entriesOffset + entryCount * sizeof(imx_fileEntry);
+	header.fileSize = header.poolOffset + poolSize;
+	
+	char tempFilename[1024];
+	snprintf(tempFilename, sizeof(tempFilename), "%s.tmp", indexFilename);
+	char result = 0;
+	FILE* file = fopen(tempFilename, "wb");
+	if(file != NULL) {
+		result = fwrite(&header, sizeof(imx_fileHeader), 1, file) == 1
+			&& (entryCount == 0 || fwrite(entries, entryCount * sizeof(imx_fileEntry), 1, file) == 1)
+			&& (poolSize == 0 || fwrite(pool, poolSize, 1, file) == 1);
+		if(fclose(file) != 0) result = 0;
+		if(result) result = (rename(tempFilename, indexFilename) == 0);
+		if(!result) remove(tempFilename);
+	}
+	
+	free(entries);
+	free(pool);
+	return result;
+}
+
+// Adds a string to the pool (returns its offset)
+static unsigned int imx_addToPool(char** pool, unsigned int* poolSize, unsigned int* poolMax, const char* str) {
+	unsigned int length = strlen(str);
+	while(*poolSize + length + 1 > *poolMax) {
+		*poolMax *= 2;
+		*pool = (char*)realloc(*pool, *poolMax);
+	}
+	unsigned int offset = *poolSize;
+	memcpy(*pool + offset, str, length + 1);
+	*poolSize += length + 1;
+	return offset;
+}
+
+// Orders entries by simplified name, then filename
+static int imx_compareEntries(const void* elem1, const void* elem2) {
+	const imx_fileEntry* entry1 = (const imx_fileEntry*)elem1;
+	const imx_fileEntry* entry2 = (const imx_fileEntry*)elem2;
+	int result = strcmp(imx_sortPool + entry1->key, imx_sortPool + entry2->key);
+	if(result != 0) return result;
+	return strcmp(imx_sortPool + entry1->filename, imx_sortPool + entry2->filename);
+}
@@ -0,0 +1,21 @@
+#ifndef IMX_H
+#define IMX_H
+
+typedef void imx_index;
+
+// Opens the name index of the given image folder, rebuilding it first if missing or out of date (null on failure)
+imx_index* imx_open(const char* dirPath, const char* indexFilename);
+
+// Finds the images whose simplified name starts with the given simplified name (returns the number found)
+int imx_find(imx_index* index, const char* simpleName, const char** filenames, int max);
+
+// Gets the number of images in the index
+unsigned int imx_getSize(imx_index* index);
+
+// Closes the index
+void imx_close(imx_index* index);
+
+// Simplifies a name for matching (drops punctuation and spaces, ignores case)
+void imx_simplify(char* buffer, const char* str);
+
+#endif /* IMX_H */
@@ -62,6 +62,9 @@ static unsigned char inp_buttonStates[12];
 static char inp_inputType = INP_TYPE_UNKNOWN;
 static int inp_hotkeyCount = 0;
 static pthread_t inp_threadId = -1;
+static pthread_mutex_t inp_inputMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t inp_inputCond;
+static char inp_inputReceived = 0;
 
 // Helper Functions
 static void inp_checkButtonInput();
@@ -113,6 +116,13 @@ int inp_init(char autoHotkey, char autoShutdown)
 	for(i=0; i<TRACK_KEY_PRESS_TOTAL; i++) inp_keyPresses[i] = 0;
 	for(i=0; i<12; i++) inp_buttonStates[i] = 0;
 	
+	//input wakeups are timed against the monotonic clock
+	pthread_condattr_t condAttr;
+	pthread_condattr_init(&condAttr);
+	pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(&inp_inputCond, &condAttr);
+	pthread_condattr_destroy(&condAttr);
+	
 	//initial device search
 	inp_updateDeviceList();
 	
@@ -187,6 +197,29 @@ unsigned char inp_getButtonState(char button)
 	return inp_buttonStates[button];
 }
 
+// Waits until input is received from a device or the timeout passes (returns 1 if input was received)
+char inp_waitForInput(int timeoutMillis)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_sec += timeoutMillis / 1000;
+	ts.tv_nsec += (timeoutMillis % 1000) * 1000000;
+	if(ts.tv_nsec >= 1000000000) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+	
+	//sleep until the polling thread signals
+	pthread_mutex_lock(&inp_inputMutex);
+	while(!inp_inputReceived) {
+		if(pthread_cond_timedwait(&inp_inputCond, &inp_inputMutex, &ts) != 0) break;
+	}
+	char received = inp_inputReceived;
+	inp_inputReceived = 0;
+	pthread_mutex_unlock(&inp_inputMutex);
+	return received;
+}
+
 // Gets the type of the last active input device
 char inp_getInputType()
 {
@@ -325,6 +358,12 @@ static void inp_checkButtonInput() {
 					inp_inputType = INP_TYPE_KEYBOARD;
 				}
 			}
+			
+			//wake anyone waiting for input
+			pthread_mutex_lock(&inp_inputMutex);
+			inp_inputReceived = 1;
+			pthread_cond_signal(&inp_inputCond);
+			pthread_mutex_unlock(&inp_inputMutex);
 		}
     }
 }
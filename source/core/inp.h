@@ -30,6 +30,9 @@ void inp_updateButtonState();
 // Gets the holding state of the given button
 unsigned char inp_getButtonState(char button);
 
+// Waits until input is received from a device or the timeout passes (returns 1 if input was received)
+char inp_waitForInput(int timeoutMillis);
+
 // Gets the type of the last active input device
 char inp_getInputType();
 
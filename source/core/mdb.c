@@ -0,0 +1,329 @@
+#include "mdb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MDB_VERSION 1
+#define MDB_NUM_FIELDS 6
+#define MDB_NUM_KEYS 5
+#define MDB_EMPTY_BUCKET 0xFFFFFFFF
+
+typedef struct {
+	char magic[4];
+	unsigned int version;
+	long long jsonMtime;
+	long long jsonSize;
+	unsigned int entryCount;
+	unsigned int bucketCount;
+	unsigned int entriesOffset;
+	unsigned int bucketsOffset;
+	unsigned int poolOffset;
+	unsigned int fileSize;
+} mdb_fileHeader;
+
+typedef struct {
+	unsigned int fields[MDB_NUM_FIELDS];
+	unsigned int size;
+} mdb_fileEntry;
+
+typedef struct {
+	unsigned int hash;
+	unsigned int keyType;
+	unsigned int entry;
+} mdb_fileBucket;
+
+typedef struct {
+	char* data;
+	unsigned int length;
+	mdb_fileHeader* header;
+	mdb_fileEntry* entries;
+	mdb_fileBucket* buckets;
+	char* pool;
+} mdb_indexData;
+
+// Constants
+static const char* mdb_magic = "MDBX";
+static const char* const mdb_fieldNames[MDB_NUM_FIELDS] = { "name", "details", "serial", "sha1_1k", "crc", "sha1" };
+
+// Helper functions
+static mdb_indexData* mdb_map(const char* indexFilename, struct stat* jsonStat);
+static char mdb_build(const char* jsonFilename, const char* indexFilename, struct stat* jsonStat);
+static char* mdb_parseString(char** cursor, char* end, unsigned int* length);
+static unsigned int mdb_addToPool(char** pool, unsigned int* poolSize, unsigned int* poolMax, const char* str, unsigned int length);
+static void mdb_insert(mdb_fileBucket* buckets, unsigned int bucketCount, char keyType, const char* key, unsigned int entry);
+static const char* mdb_entryKey(mdb_fileEntry* entry, char* pool, char keyType, char* buffer, unsigned int max);
+
+// Util functions
+static unsigned int mdb_hash(char keyType, const char* key);
+
+// Opens the binary index of the given JSON database, rebuilding it first if missing or out of date (null on failure)
+mdb_index* mdb_open(const char* jsonFilename, const char* indexFilename)
+{
+	struct stat jsonStat;
+	if(stat(jsonFilename, &jsonStat) != 0) return 0;
+	
+	mdb_indexData* indexData = mdb_map(indexFilename, &jsonStat);
+	if(indexData == 0) {
+		if(mdb_build(jsonFilename, indexFilename, &jsonStat) == 0) return 0;
+		indexData = mdb_map(indexFilename, &jsonStat);
+	}
+	return (mdb_index*)indexData;
+}
+
+// Looks up an entry by the given key type (name key is "name details"), returns 1 if found
+char mdb_find(mdb_index* index, char keyType, const char* key, mdb_entry* entry)
+{
+	mdb_indexData* indexData = (mdb_indexData*)index;
+	if(indexData == 0 || key == 0 || key[0] == 0 || (unsigned char)keyType >= MDB_NUM_KEYS) return 0;
+	
+	//open addressing with linear probing
+	char buffer[512];
+	unsigned int hash = mdb_hash(keyType, key);
+	unsigned int mask = indexData->header->bucketCount - 1;
+	unsigned int i;
+	for(i = hash & mask; indexData->buckets[i].entry != MDB_EMPTY_BUCKET; i = (i + 1) & mask) {
+		mdb_fileBucket* bucket = &indexData->buckets[i];
+		if(bucket->hash != hash || bucket->keyType != (unsigned int)keyType) continue;
+		
+		mdb_fileEntry* fileEntry = &indexData->entries[bucket->entry];
+		if(strcmp(mdb_entryKey(fileEntry, indexData->pool, keyType, buffer, sizeof(buffer)), key) != 0) continue;
+		
+		entry->name = indexData->pool + fileEntry->fields[0];
+		entry->details = indexData->pool + fileEntry->fields[1];
+		entry->serial = indexData->pool + fileEntry->fields[2];
+		entry->sha1_1k = indexData->pool + fileEntry->fields[3];
+		entry->crc = indexData->pool + fileEntry->fields[4];
+		entry->sha1 = indexData->pool + fileEntry->fields[5];
+		entry->size = fileEntry->size;
+		return 1;
+	}
+	return 0;
+}
+
+// Gets the number of entries in the index
+unsigned int mdb_getSize(mdb_index* index)
+{
+	mdb_indexData* indexData = (mdb_indexData*)index;
+	if(indexData == 0) return 0;
+	return indexData->header->entryCount;
+}
+
+// Closes the index
+void mdb_close(mdb_index* index)
+{
+	mdb_indexData* indexData = (mdb_indexData*)index;
+	if(indexData == 0) return;
+	
+	munmap(indexData->data, indexData->length);
+	free(indexData);
+}
+
+// Maps an index file and checks it still matches the JSON it was built from
+static mdb_indexData* mdb_map(const char* indexFilename, struct stat* jsonStat) {
+	int fd = open(indexFilename, O_RDONLY);
+	if(fd < 0) return 0;
+	struct stat indexStat;
+	if(fstat(fd, &indexStat) != 0 || indexStat.st_size < (off_t)sizeof(mdb_fileHeader)) {
+		close(fd);
+		return 0;
+	}
+	char* data = (char*)mmap(0, indexStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED) return 0;
+	
+	mdb_fileHeader* header = (mdb_fileHeader*)data;
+	if(memcmp(header->magic, mdb_magic, 4) != 0 || header->version != MDB_VERSION || header->fileSize != (unsigned int)indexStat.st_size
+		|| header->jsonMtime != (long long)jsonStat->st_mtime || header->jsonSize != (long long)jsonStat->st_size
+		|| header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0) {
+		munmap(data, indexStat.st_size);
+		return 0;
+	}
+	
+	mdb_indexData* indexData = (mdb_indexData*)malloc(sizeof(mdb_indexData));
+	indexData->data = data;
+	indexData->length = indexStat.st_size;
+	indexData->header = header;
+	indexData->entries = (mdb_fileEntry*)(data + header->entriesOffset);
+	indexData->buckets = (mdb_fileBucket*)(data + header->bucketsOffset);
+	indexData->pool = data + header->poolOffset;
+	return indexData;
+}
+
+// Parses the JSON database and writes out its index
+static char mdb_build(const char* jsonFilename, const char* indexFilename, struct stat* jsonStat) {
+	unsigned int i, j;
+	
+	//read the whole JSON so entries never straddle a buffer
+	FILE* file = fopen(jsonFilename, "rb");
+	if(file == NULL) return 0;
+	char* json = (char*)malloc(jsonStat->st_size + 1);
+	if(fread(json, jsonStat->st_size, 1, file) != 1) {
+		fclose(file);
+		free(json);
+		return 0;
+	}
+	fclose(file);
+	json[jsonStat->st_size] = 0;
+	char* end = json + jsonStat->st_size;
+	
+	//string pool starts with the empty string so missing fields point at offset 0
+	unsigned int poolSize = 1;
+	unsigned int poolMax = 65536;
+	char* pool = (char*)malloc(poolMax);
+	pool[0] = 0;
+	unsigned int entryCount = 0;
+	unsigned int entryMax = 1024;
+	mdb_fileEntry* entries = (mdb_fileEntry*)malloc(entryMax * sizeof(mdb_fileEntry));
+	
+	//each flat object is one entry of "key": "value" pairs
+	char* c = json;
+	while(c < end) {
+		if(*c++ != '{') continue;
+		if(entryCount == entryMax) {
+			entryMax *= 2;
+			entries = (mdb_fileEntry*)realloc(entries, entryMax * sizeof(mdb_fileEntry));
+		}
+		mdb_fileEntry* entry = &entries[entryCount++];
+		memset(entry, 0, sizeof(mdb_fileEntry));
+		
+		while(c < end && *c != '}') {
+			if(*c != '"') {
+				c++;
+				continue;
+			}
+			unsigned int keyLength, valueLength;
+			char* key = mdb_parseString(&c, end, &keyLength);
+			while(c < end && *c != '"' && *c != '}') c++;
+			if(c >= end || *c == '}') break;
+			char* value = mdb_parseString(&c, end, &valueLength);
+			
+			for(j = 0; j < MDB_NUM_FIELDS; j++) {
+				if(strlen(mdb_fieldNames[j]) == keyLength && strncmp(key, mdb_fieldNames[j], keyLength) == 0) {
+					entry->fields[j] = mdb_addToPool(&pool, &poolSize, &poolMax, value, valueLength);
+				}
+			}
+			if(keyLength == 4 && strncmp(key, "size", 4) == 0) entry->size = strtoul(value, 0, 10);
+		}
+	}
+	free(json);
+	
+	//hash table at most half full
+	unsigned int bucketCount = 16;
+	while(bucketCount < entryCount * MDB_NUM_KEYS * 2) bucketCount *= 2;
+	mdb_fileBucket* buckets = (mdb_fileBucket*)malloc(bucketCount * sizeof(mdb_fileBucket));
+	for(i = 0; i < bucketCount; i++) buckets[i].entry = MDB_EMPTY_BUCKET;
+	char buffer[512];
+	for(i = 0; i < entryCount; i++) {
+		for(j = 0; j < MDB_NUM_KEYS; j++) {
+			const char* key = mdb_entryKey(&entries[i], pool, j, buffer, sizeof(buffer));
+			if(key[0] != 0) mdb_insert(buckets, bucketCount, j, key, i);
+		}
+	}
+	
+	//write to a temp file then move it into place so readers never map a partial index
+	mdb_fileHeader header;
+	memset(&header, 0, sizeof(mdb_fileHeader));
+	memcpy(header.magic, mdb_magic, 4);
+	header.version = MDB_VERSION;
+	header.jsonMtime = jsonStat->st_mtime;
+	header.jsonSize = jsonStat->st_size;
+	header.entryCount = entryCount;
+	header.bucketCount = bucketCount;
+	header.entriesOffset = sizeof(mdb_fileHeader);
+	header.bucketsOffset = header.entriesOffset + entryCount * sizeof(mdb_fileEntry);
+	header.poolOffset = header.bucketsOffset + bucketCount * sizeof(mdb_fileBucket);
+	header.fileSize = header.poolOffset + poolSize;
+	
+	char tempFilename[1024];
+	snprintf(tempFilename, sizeof(tempFilename), "%s.tmp", indexFilename);
+	char result = 0;
+	file = fopen(tempFilename, "wb");
+	if(file != NULL) {
+		result = fwrite(&header, sizeof(mdb_fileHeader), 1, file) == 1
+			&& (entryCount == 0 || fwrite(entries, entryCount * sizeof(mdb_fileEntry), 1, file) == 1)
+			&& fwrite(buckets, bucketCount * sizeof(mdb_fileBucket), 1, file) == 1
+			&& fwrite(pool, poolSize, 1, file) == 1;
+		if(fclose(file) != 0) result = 0;
+		if(result) result = (rename(tempFilename, indexFilename) == 0);
+		if(!result) remove(tempFilename);
+	}
+	
+	free(entries);
+	free(buckets);
+	free(pool);
+	return result;
+}
+
+// Unescapes the string starting at the given quote in place and moves past its closing quote (returns its start)
+static char* mdb_parseString(char** cursor, char* end, unsigned int* length) {
+	char* str = *cursor + 1;
+	char* in = str;
+	char* out = str;
+	while(in < end && *in != '"') {
+		if(*in == '\\' && in + 1 < end) {
+			in++;
+			if(*in == 'n') *out++ = '\n';
+			else if(*in == 't') *out++ = '\t';
+			else if(*in == 'u') {
+				//non-ascii characters aren't needed for matching
+				*out++ = '?';
+				in += 4;
+			}
+			else *out++ = *in;
+			if(in < end) in++;
+		} else {
+			*out++ = *in++;
+		}
+	}
+	*length = out - str;
+	*cursor = (in < end) ? in + 1 : end;
+	return str;
+}
+
+// Adds a string to the pool (returns its offset)
+static unsigned int mdb_addToPool(char** pool, unsigned int* poolSize, unsigned int* poolMax, const char* str, unsigned int length) {
+	while(*poolSize + length + 1 > *poolMax) {
+		*poolMax *= 2;
+		*pool = (char*)realloc(*pool, *poolMax);
+	}
+	unsigned int offset = *poolSize;
+	memcpy(*pool + offset, str, length);
+	(*pool)[offset + length] = 0;
+	*poolSize += length + 1;
+	return offset;
+}
+
+// Inserts a key into the hash table
+static void mdb_insert(mdb_fileBucket* buckets, unsigned int bucketCount, char keyType, const char* key, unsigned int entry) {
+	unsigned int hash = mdb_hash(keyType, key);
+	unsigned int i = hash & (bucketCount - 1);
+	while(buckets[i].entry != MDB_EMPTY_BUCKET) i = (i + 1) & (bucketCount - 1);
+	buckets[i].hash = hash;
+	buckets[i].keyType = keyType;
+	buckets[i].entry = entry;
+}
+
+// Gets the key of the given type for an entry
+static const char* mdb_entryKey(mdb_fileEntry* entry, char* pool, char keyType, char* buffer, unsigned int max) {
+	if(keyType == MDB_KEY_SERIAL) return pool + entry->fields[2];
+	if(keyType == MDB_KEY_SHA1_1K) return pool + entry->fields[3];
+	if(keyType == MDB_KEY_CRC) return pool + entry->fields[4];
+	if(keyType == MDB_KEY_SHA1) return pool + entry->fields[5];
+	
+	//name key is the name and details together, like catalog filenames
+	if(pool[entry->fields[0]] == 0) return pool;
+	snprintf(buffer, max, "%s %s", pool + entry->fields[0], pool + entry->fields[1]);
+	return buffer;
+}
+
+// Hashes a key along with its type (FNV-1a)
+static unsigned int mdb_hash(char keyType, const char* key) {
+	unsigned int hash = 2166136261u;
+	hash = (hash ^ (unsigned char)keyType) * 16777619u;
+	while(*key) hash = (hash ^ (unsigned char)*key++) * 16777619u;
+	return hash;
+}
@@ -0,0 +1,34 @@
+#ifndef MDB_H
+#define MDB_H
+
+#define MDB_KEY_SERIAL 0
+#define MDB_KEY_SHA1_1K 1
+#define MDB_KEY_CRC 2
+#define MDB_KEY_SHA1 3
+#define MDB_KEY_NAME 4
+
+typedef void mdb_index;
+
+typedef struct {
+	const char* name;
+	const char* details;
+	const char* serial;
+	const char* sha1_1k;
+	const char* crc;
+	const char* sha1;
+	unsigned int size;
+} mdb_entry;
+
+// Opens the binary index of the given JSON database, rebuilding it first if missing or out of date (null on failure)
+mdb_index* mdb_open(const char* jsonFilename, const char* indexFilename);
+
+// Looks up an entry by the given key type (name key is "name details"), returns 1 if found
+char mdb_find(mdb_index* index, char keyType, const char* key, mdb_entry* entry);
+
+// Gets the number of entries in the index
+unsigned int mdb_getSize(mdb_index* index);
+
+// Closes the index
+void mdb_close(mdb_index* index);
+
+#endif /* MDB_H */
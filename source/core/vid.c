@@ -1,6 +1,10 @@
 #include "vid.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h> 
+#include <dirent.h>
+#include <sys/stat.h>
+#include <pthread.h>
 #include <SDL/SDL.h>
 #include <SDL/SDL_getenv.h>
 #include <SDL/SDL_image.h>
@@ -13,15 +17,150 @@
 
 #define SURFACE_TYPE SDL_SWSURFACE
 #define MAX_IMAGE_CACHE_FILENAME_SIZE 256
+#define VID_MAX_IMAGE_SIZES 4
+#define VID_MAX_OVERLAYS 8
+#define VID_MAX_CACHED_TEXTURES 128
+#define VID_DEFAULT_TEXTURE_BUDGET (16*1024*1024)
+#define VID_DEFAULT_THUMB_BUDGET (128*1024*1024)
+#define VID_MAX_FONTS 8
+#define VID_MAX_ATLASES 16
+#define VID_FIRST_GLYPH 32
+#define VID_NUM_GLYPHS 95
+#define VID_MAX_IMAGE_REQUESTS 96
+#define VID_MAX_FRAMES 32
+#define VID_FRAME_MAX_LINES 8
+
+#define VID_REQUEST_FREE 0
+#define VID_REQUEST_QUEUED 1
+#define VID_REQUEST_LOADING 2
+#define VID_REQUEST_DONE 3
+#define VID_REQUEST_CANCELLED 4
+
+typedef struct {
+	char magic[4];
+	char source[MAX_IMAGE_CACHE_FILENAME_SIZE];
+	long long sourceMtime;
+	int w;
+	int h;
+	int smooth;
+	int screenFormat[5];
+	int format[5];
+} vid_thumbHeader;
+
+typedef struct {
+	char name[32];
+	long long mtime;
+	long long bytes;
+} vid_thumbFile;
+
+typedef struct {
+	char filename[MAX_IMAGE_CACHE_FILENAME_SIZE];
+	int w;
+	int h;
+	char smooth;
+	SDL_Surface* surface;
+} vid_overlay;
+
+typedef struct {
+	char filename[MAX_IMAGE_CACHE_FILENAME_SIZE];
+	int w;
+	int h;
+	char smooth;
+	unsigned int lastUsed;
+	unsigned int bytes;
+	SDL_Surface* surface;
+} vid_cachedTexture;
+
+typedef struct {
+	char style;
+	int w;
+	int h;
+	Uint32 color;
+	SDL_Surface* surface;
+} vid_frame;
+
+typedef struct {
+	int size;
+	TTF_Font* font;
+} vid_font;
+
+typedef struct {
+	int size;
+	char bold;
+	Uint32 foreground;
+	Uint32 background;
+	SDL_Surface* surface;
+	short glyphX[VID_NUM_GLYPHS];
+	short glyphW[VID_NUM_GLYPHS];
+} vid_atlas;
+
+typedef struct {
+	int id;
+	char state;
+	char prefetch;
+	char filename[MAX_IMAGE_CACHE_FILENAME_SIZE];
+	int count;
+	int w[VID_MAX_IMAGE_SIZES];
+	int h[VID_MAX_IMAGE_SIZES];
+	char smooth;
+	SDL_Surface* surfaces[VID_MAX_IMAGE_SIZES];
+} vid_imageRequest;
+
+// Constants
+static const char* vid_thumbMagic = "VTHB";
+static const char* vid_fontFile = "data/img/font.ttf";
 
 // Data
 static char vid_isInitFlag = INIT_FLAG_NOT;
 static SDL_Surface* vid_scrMain = NULL;
 static char vid_cachedImageFilename[MAX_IMAGE_CACHE_FILENAME_SIZE];
 static SDL_Surface* vid_cachedImage = NULL;
-static int vid_cachedFontSize = -1;
-static TTF_Font* vid_cachedFont = NULL;
 static SDL_Surface* vid_shade = NULL;
+static char vid_thumbPath[MAX_IMAGE_CACHE_FILENAME_SIZE] = "";
+static long long vid_thumbBudget = VID_DEFAULT_THUMB_BUDGET;
+static long long vid_thumbBytes = -1;
+static pthread_mutex_t vid_thumbMutex = PTHREAD_MUTEX_INITIALIZER;
+static vid_overlay vid_overlays[VID_MAX_OVERLAYS];
+static int vid_nextOverlay = 0;
+static vid_cachedTexture vid_textures[VID_MAX_CACHED_TEXTURES];
+static unsigned int vid_textureBudget = VID_DEFAULT_TEXTURE_BUDGET;
+static unsigned int vid_textureBytes = 0;
+static unsigned int vid_textureClock = 0;
+static unsigned int vid_textureHits = 0;
+static unsigned int vid_textureMisses = 0;
+static unsigned int vid_textureEvictions = 0;
+static vid_frame vid_frames[VID_MAX_FRAMES];
+static int vid_nextFrame = 0;
+static vid_font vid_fonts[VID_MAX_FONTS];
+static vid_atlas vid_atlases[VID_MAX_ATLASES];
+static int vid_nextAtlas = 0;
+static vid_imageRequest vid_requests[VID_MAX_IMAGE_REQUESTS];
+static int vid_nextRequestId = 1;
+static char vid_workerRunning = 0;
+static pthread_t vid_workerThread;
+static pthread_mutex_t vid_requestMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vid_requestCond = PTHREAD_COND_INITIALIZER;
+
+// Helper functions
+static SDL_Surface* vid_scaleSurface(SDL_Surface* source, int w, int h, char smooth);
+static SDL_Surface* vid_getOverlay(const char* filename, int w, int h, char smooth);
+static SDL_Surface* vid_findTexture(const char* filename, int w, int h, char smooth);
+static void vid_cacheTexture(const char* filename, int w, int h, char smooth, SDL_Surface* surface);
+static void vid_evictTexture(vid_cachedTexture* entry);
+static SDL_Surface* vid_ownTexture(SDL_Surface* surface);
+static TTF_Font* vid_getFont(int size);
+static vid_atlas* vid_getAtlas(int size, char bold, SDL_Color foreground, SDL_Color background);
+static char vid_thumbKey(vid_thumbHeader* header, char* thumbFilename, const char* filename, int w, int h, char smooth);
+static SDL_Surface* vid_readThumb(const char* thumbFilename, vid_thumbHeader* header);
+static void vid_writeThumb(const char* thumbFilename, vid_thumbHeader* header, SDL_Surface* surface);
+static char vid_hasThumb(const char* thumbFilename, vid_thumbHeader* header);
+static void vid_trimThumbs();
+static int vid_compareThumbAge(const void* a, const void* b);
+static void vid_loadImageSizes(const char* filename, int count, const int* w, const int* h, char smooth, SDL_Surface** surfaces, char mainThread);
+static int vid_queueImageRequest(const char* filename, int count, const int* w, const int* h, char smooth, char prefetch, SDL_Surface** surfaces);
+static void* vid_imageWorker(void* args);
+static void vid_stopImageWorker();
+static int vid_frameLines(char style, int w, int h, unsigned char r, unsigned char g, unsigned char b, int lines[][4], SDL_Color* lineColors);
 
 // Setup and initialize the Video interface
 int vid_init()
@@ -152,30 +291,142 @@ void vid_drawTexture(VidTexture* t, int x, int y)
 // Generates a texture from the given image file
 VidTexture* vid_generateImageTexture(const char* filename, int w, int h, char smooth)
 {
+	VidTexture* texture = 0;
+	vid_generateImageTextures(filename, 1, &w, &h, smooth, &texture);
+	return texture;
+}
+
+// Generates textures of several sizes from one image file, decoding it once and scaling each size from the one before (largest first)
+void vid_generateImageTextures(const char* filename, int count, const int* w, const int* h, char smooth, VidTexture** textures)
+{
+	for(int i=0; i<count; i++) textures[i] = 0;
 	if(vid_scrMain) {
-		//image already cached?
-		if(strcmp(filename, vid_cachedImageFilename) != 0) {
-			if(vid_cachedImage) SDL_FreeSurface(vid_cachedImage);
-			SDL_Surface* imgSurfaceRaw = IMG_Load(filename);
-			vid_cachedImage = SDL_ConvertSurface(imgSurfaceRaw, vid_scrMain->format, SURFACE_TYPE);
-			SDL_FreeSurface(imgSurfaceRaw);
-			strncpy(vid_cachedImageFilename, filename, MAX_IMAGE_CACHE_FILENAME_SIZE);
-			vid_cachedImageFilename[MAX_IMAGE_CACHE_FILENAME_SIZE-1] = 0;
+		//shared textures already in memory?
+		char cached[VID_MAX_IMAGE_SIZES];
+		if(count > VID_MAX_IMAGE_SIZES) count = VID_MAX_IMAGE_SIZES;
+		for(int i=0; i<count; i++) {
+			textures[i] = (VidTexture*)vid_findTexture(filename, w[i], h[i], smooth);
+			cached[i] = (textures[i] != 0);
 		}
 		
-		SDL_Surface* imgSurface = NULL;
-		if(vid_cachedImage->format->BitsPerPixel == 32 || vid_cachedImage->format->BitsPerPixel == 8) {
-			imgSurface = zoomSurface(vid_cachedImage, (double)w/(double)(vid_cachedImage->w), (double)h/(double)(vid_cachedImage->h), smooth);
-		} else {
-			//make sure to convert back to optimized format
-			SDL_Surface* imgSurfaceRaw2 = zoomSurface(vid_cachedImage, (double)w/(double)(vid_cachedImage->w), (double)h/(double)(vid_cachedImage->h), smooth);
-			imgSurface = SDL_ConvertSurface(imgSurfaceRaw2, vid_scrMain->format, SURFACE_TYPE);
-			SDL_FreeSurface(imgSurfaceRaw2);
+		//load the rest and share them
+		vid_loadImageSizes(filename, count, w, h, smooth, (SDL_Surface**)textures, 1);
+		for(int i=0; i<count; i++) {
+			if(!cached[i] && textures[i]) vid_cacheTexture(filename, w[i], h[i], smooth, (SDL_Surface*)textures[i]);
+		}
+	}
+}
+
+// Sets the folder to keep pre-scaled copies of image textures in (null disables)
+void vid_setImageCache(const char* dirPath)
+{
+	pthread_mutex_lock(&vid_thumbMutex);
+	vid_thumbPath[0] = 0;
+	vid_thumbBytes = -1;
+	if(dirPath && strlen(dirPath) < MAX_IMAGE_CACHE_FILENAME_SIZE) {
+		mkdir(dirPath, 0777);
+		strcpy(vid_thumbPath, dirPath);
+	}
+	pthread_mutex_unlock(&vid_thumbMutex);
+}
+
+// Sets the most disk space the pre-scaled copies take up in bytes (the oldest are deleted first)
+void vid_setImageCacheBudget(unsigned int bytes)
+{
+	pthread_mutex_lock(&vid_thumbMutex);
+	vid_thumbBudget = bytes;
+	vid_thumbBytes = -1;
+	vid_trimThumbs();
+	pthread_mutex_unlock(&vid_thumbMutex);
+}
+
+// Queues textures of several sizes from one image file to be decoded and scaled in the background (returns a request id, 0 if not queued)
+int vid_requestImageTextures(const char* filename, int count, const int* w, const int* h, char smooth)
+{
+	if(vid_scrMain == NULL || filename == NULL) return 0;
+	if(count > VID_MAX_IMAGE_SIZES) count = VID_MAX_IMAGE_SIZES;
+	
+	//already in memory needs no decoding (partly cached images are loaded whole off the main thread)
+	SDL_Surface* surfaces[VID_MAX_IMAGE_SIZES];
+	char cached = 1;
+	for(int i=0; i<count; i++) {
+		surfaces[i] = vid_findTexture(filename, w[i], h[i], smooth);
+		if(surfaces[i] == NULL) cached = 0;
+	}
+	if(!cached) {
+		for(int i=0; i<count; i++) {
+			if(surfaces[i]) SDL_FreeSurface(surfaces[i]);
+		}
+	}
+	int request = vid_queueImageRequest(filename, count, w, h, smooth, 0, cached ? surfaces : NULL);
+	if(request == 0 && cached) {
+		for(int i=0; i<count; i++) SDL_FreeSurface(surfaces[i]);
+	}
+	return request;
+}
+
+// Collects the textures of a background request (returns 1 once collected, 0 while still loading, -1 for an unknown request)
+int vid_collectImageTextures(int request, VidTexture** textures)
+{
+	int result = -1;
+	pthread_mutex_lock(&vid_requestMutex);
+	for(int r=0; r<VID_MAX_IMAGE_REQUESTS; r++) {
+		vid_imageRequest* req = &vid_requests[r];
+		if(req->state == VID_REQUEST_FREE || req->id != request) continue;
+		if(req->state != VID_REQUEST_DONE) {
+			result = 0;
+			break;
 		}
 		
-		return (VidTexture*)imgSurface;
+		//share the results, unless the same sizes were loaded some other way in the meantime
+		for(int i=0; i<req->count; i++) {
+			SDL_Surface* shared = req->surfaces[i] ? vid_findTexture(req->filename, req->w[i], req->h[i], req->smooth) : NULL;
+			if(shared) {
+				SDL_FreeSurface(req->surfaces[i]);
+				req->surfaces[i] = shared;
+			} else if(req->surfaces[i]) {
+				vid_cacheTexture(req->filename, req->w[i], req->h[i], req->smooth, req->surfaces[i]);
+			}
+			textures[i] = (VidTexture*)req->surfaces[i];
+			req->surfaces[i] = NULL;
+		}
+		req->state = VID_REQUEST_FREE;
+		result = 1;
+		break;
 	}
-	return 0;
+	pthread_mutex_unlock(&vid_requestMutex);
+	return result;
+}
+
+// Queues an image file to be scaled into the pre-scaled copies on disk in the background without keeping it in memory (returns a request id, 0 if not queued)
+int vid_prefetchImageTextures(const char* filename, int count, const int* w, const int* h, char smooth)
+{
+	if(vid_scrMain == NULL || filename == NULL || vid_thumbPath[0] == 0) return 0;
+	if(count > VID_MAX_IMAGE_SIZES) count = VID_MAX_IMAGE_SIZES;
+	return vid_queueImageRequest(filename, count, w, h, smooth, 1, NULL);
+}
+
+// Cancels a background request, dropping anything it loaded
+void vid_cancelImageTextures(int request)
+{
+	pthread_mutex_lock(&vid_requestMutex);
+	for(int r=0; r<VID_MAX_IMAGE_REQUESTS; r++) {
+		vid_imageRequest* req = &vid_requests[r];
+		if(req->state == VID_REQUEST_FREE || req->id != request) continue;
+		
+		//the worker drops what it is loading once it finishes
+		if(req->state == VID_REQUEST_LOADING) {
+			req->state = VID_REQUEST_CANCELLED;
+		} else if(req->state != VID_REQUEST_CANCELLED) {
+			for(int i=0; i<req->count; i++) {
+				if(req->surfaces[i]) SDL_FreeSurface(req->surfaces[i]);
+				req->surfaces[i] = NULL;
+			}
+			req->state = VID_REQUEST_FREE;
+		}
+		break;
+	}
+	pthread_mutex_unlock(&vid_requestMutex);
 }
 
 // Generates a texture from the given text
@@ -183,21 +434,32 @@ VidTexture* vid_generateTextTexture(const char* text, unsigned char rF, unsigned
 		unsigned char rB, unsigned char gB, unsigned char bB, char fontSize, char isBold)
 {
 	if(vid_scrMain) {
-		//font already cached?
-		if(vid_cachedFontSize != (int)fontSize) {
-			if(vid_cachedFont) TTF_CloseFont(vid_cachedFont);
-			vid_cachedFont = TTF_OpenFont("data/img/font.ttf", fontSize);
-			vid_cachedFontSize = fontSize;
-		}
-		
 		SDL_Color foregroundColor = {rF, gF, bF};
 		SDL_Color backgroundColor = {rB, gB, bB};
-		if(isBold) TTF_SetFontStyle(vid_cachedFont, TTF_STYLE_BOLD);
-		else TTF_SetFontStyle(vid_cachedFont, TTF_STYLE_NORMAL);
-		SDL_Surface* textSurfaceRaw = TTF_RenderText_Shaded(vid_cachedFont, text, foregroundColor, backgroundColor);
-		SDL_Surface* textSurface = SDL_ConvertSurface(textSurfaceRaw, vid_scrMain->format, SURFACE_TYPE);
+		vid_atlas* atlas = vid_getAtlas(fontSize, isBold, foregroundColor, backgroundColor);
+		if(atlas == NULL || text == 0) return 0;
+		
+		//lay the text out from the glyph widths (characters outside the atlas show as '?')
+		int width = 0;
+		for(const char* c=text; *c; c++) {
+			int glyph = (unsigned char)*c - VID_FIRST_GLYPH;
+			if(glyph < 0 || glyph >= VID_NUM_GLYPHS) glyph = '?' - VID_FIRST_GLYPH;
+			width += atlas->glyphW[glyph];
+		}
+		if(width == 0) return 0;
+		
+		//blit each glyph from the atlas
+		SDL_Surface* textSurface = SDL_CreateRGBSurface(SURFACE_TYPE, width, atlas->surface->h, vid_scrMain->format->BitsPerPixel, 
+			vid_scrMain->format->Rmask, vid_scrMain->format->Gmask, vid_scrMain->format->Bmask, vid_scrMain->format->Amask);
+		SDL_Rect to = {0, 0, 0, 0};
+		for(const char* c=text; *c; c++) {
+			int glyph = (unsigned char)*c - VID_FIRST_GLYPH;
+			if(glyph < 0 || glyph >= VID_NUM_GLYPHS) glyph = '?' - VID_FIRST_GLYPH;
+			SDL_Rect from = {atlas->glyphX[glyph], 0, (unsigned short)atlas->glyphW[glyph], (unsigned short)atlas->surface->h};
+			SDL_BlitSurface(atlas->surface, &from, textSurface, &to);
+			to.x += atlas->glyphW[glyph];
+		}
 		
-		SDL_FreeSurface(textSurfaceRaw);
 		return (VidTexture*)textSurface;
 	}
 	return 0;
@@ -217,29 +479,26 @@ VidTexture* vid_generateScreenTexture(int x, int y, int w, int h)
 	return 0;
 }
 
-// Compsites the given image onto the given texture
-void vid_compositeImageToTexture(VidTexture* t, const char* filename, unsigned char opaque, char smooth)
+// Compsites the given image onto the given texture (returns the texture to use, a private copy if it was shared)
+VidTexture* vid_compositeImageToTexture(VidTexture* t, const char* filename, unsigned char opaque, char smooth)
 {
-	if(vid_scrMain) {
-		SDL_Surface* tSurface = (SDL_Surface*)t;
-		
-		SDL_Surface* imgSurfaceRaw = IMG_Load(filename);
-		SDL_Surface* imgSurfaceZoomed = zoomSurface(imgSurfaceRaw, (double)tSurface->w/(double)(imgSurfaceRaw->w), (double)tSurface->h/(double)(imgSurfaceRaw->h), smooth);
-		SDL_FreeSurface(imgSurfaceRaw);
-		SDL_Surface* imgSurfaceOpt = SDL_ConvertSurface(imgSurfaceZoomed, vid_scrMain->format, SURFACE_TYPE);
-		SDL_FreeSurface(imgSurfaceZoomed);
-		
-		SDL_SetAlpha(imgSurfaceOpt, SDL_SRCALPHA, opaque);
-		SDL_BlitSurface(imgSurfaceOpt, NULL, tSurface, NULL);
-		SDL_FreeSurface(imgSurfaceOpt);
+	if(vid_scrMain && t) {
+		SDL_Surface* tSurface = vid_ownTexture((SDL_Surface*)t);
+		SDL_Surface* overlay = vid_getOverlay(filename, tSurface->w, tSurface->h, smooth);
+		if(overlay) {
+			SDL_SetAlpha(overlay, SDL_SRCALPHA, opaque);
+			SDL_BlitSurface(overlay, NULL, tSurface, NULL);
+		}
+		return (VidTexture*)tSurface;
 	}
+	return t;
 }
 
-// Compsites the given color onto the given texture
-void vid_compositeColorToTexture(VidTexture* t, unsigned char r, unsigned char g, unsigned char b, unsigned char opaque)
+// Compsites the given color onto the given texture (returns the texture to use, a private copy if it was shared)
+VidTexture* vid_compositeColorToTexture(VidTexture* t, unsigned char r, unsigned char g, unsigned char b, unsigned char opaque)
 {
-	if(vid_scrMain) {
-		SDL_Surface* tSurface = (SDL_Surface*)t;
+	if(vid_scrMain && t) {
+		SDL_Surface* tSurface = vid_ownTexture((SDL_Surface*)t);
 		
 		SDL_Surface* colorSurface = SDL_CreateRGBSurface(SURFACE_TYPE, tSurface->w, tSurface->h, tSurface->format->BitsPerPixel, 
 			tSurface->format->Rmask, tSurface->format->Gmask, tSurface->format->Bmask, tSurface->format->Amask);
@@ -250,10 +509,84 @@ void vid_compositeColorToTexture(VidTexture* t, unsigned char r, unsigned char g
 		SDL_SetAlpha(colorSurface, SDL_SRCALPHA, opaque);
 		SDL_BlitSurface(colorSurface, NULL, tSurface, NULL);
 		SDL_FreeSurface(colorSurface);
+		return (VidTexture*)tSurface;
+	}
+	return t;
+}
+
+// Draws the drop shadow or outline (in the given color) around a box straight to the screen (for boxes still changing size)
+void vid_drawFrame(char style, int x, int y, int w, int h, unsigned char r, unsigned char g, unsigned char b)
+{
+	if(w <= 0 || h <= 0) return;
+	int lines[VID_FRAME_MAX_LINES][4];
+	SDL_Color lineColors[VID_FRAME_MAX_LINES];
+	vid_frameLines(style, w, h, r, g, b, lines, lineColors);
+	for(int i=0; i<VID_FRAME_MAX_LINES; i++) {
+		vid_drawBox(x+lines[i][0], y+lines[i][1], lines[i][2], lines[i][3], lineColors[i].r, lineColors[i].g, lineColors[i].b, 255);
+	}
+}
+
+// Generates the drop shadow or outline (in the given color) around a box of the given size as one texture, shared between boxes alike (draw it up and left by the style's border)
+VidTexture* vid_generateFrameTexture(char style, int w, int h, unsigned char r, unsigned char g, unsigned char b)
+{
+	if(vid_scrMain == NULL || w <= 0 || h <= 0) return 0;
+	Uint32 color = (style == VID_FRAME_OUTLINE) ? ((r << 16) | (g << 8) | b) : 0;
+	for(int i=0; i<VID_MAX_FRAMES; i++) {
+		vid_frame* frame = &vid_frames[i];
+		if(frame->surface && frame->style == style && frame->w == w && frame->h == h && frame->color == color) {
+			frame->surface->refcount++;
+			return (VidTexture*)frame->surface;
+		}
+	}
+	
+	//lines around the box (x, y, w, h from the box corner) each with its own color
+	int lines[VID_FRAME_MAX_LINES][4];
+	SDL_Color lineColors[VID_FRAME_MAX_LINES];
+	int border = vid_frameLines(style, w, h, r, g, b, lines, lineColors);
+	
+	//everything but the lines is see through (run length encoded so the inside costs next to nothing to blit)
+	SDL_Surface* surface = SDL_CreateRGBSurface(SURFACE_TYPE, w+border*2, h+border*2, vid_scrMain->format->BitsPerPixel, 
+		vid_scrMain->format->Rmask, vid_scrMain->format->Gmask, vid_scrMain->format->Bmask, vid_scrMain->format->Amask);
+	if(surface == NULL) return 0;
+	Uint32 key = SDL_MapRGB(surface->format, 255, 0, 255);
+	if(style == VID_FRAME_OUTLINE && r == 255 && g == 0 && b == 255) key = SDL_MapRGB(surface->format, 0, 255, 0);
+	SDL_FillRect(surface, NULL, key);
+	for(int i=0; i<VID_FRAME_MAX_LINES; i++) {
+		SDL_Rect rect = {(signed short)(lines[i][0]+border), (signed short)(lines[i][1]+border), (unsigned short)lines[i][2], (unsigned short)lines[i][3]};
+		SDL_FillRect(surface, &rect, SDL_MapRGB(surface->format, lineColors[i].r, lineColors[i].g, lineColors[i].b));
 	}
+	SDL_SetColorKey(surface, SDL_SRCCOLORKEY | SDL_RLEACCEL, key);
+	
+	//replace the oldest entry (the caller keeps its own reference)
+	vid_frame* frame = &vid_frames[vid_nextFrame];
+	vid_nextFrame = (vid_nextFrame + 1) % VID_MAX_FRAMES;
+	if(frame->surface) SDL_FreeSurface(frame->surface);
+	frame->style = style;
+	frame->w = w;
+	frame->h = h;
+	frame->color = color;
+	frame->surface = surface;
+	surface->refcount++;
+	return (VidTexture*)surface;
 }
 
-// Clears memory for the given texture
+// Sets the most memory the texture cache holds on to in bytes (textures still in use are kept until released)
+void vid_setTextureCacheBudget(unsigned int bytes)
+{
+	vid_textureBudget = bytes;
+	vid_cacheTexture(0, 0, 0, 0, NULL);
+}
+
+// Gets the texture cache counters (any can be null)
+void vid_getTextureCacheStats(unsigned int* hits, unsigned int* misses, unsigned int* evictions, unsigned int* bytes)
+{
+	if(hits) *hits = vid_textureHits;
+	if(misses) *misses = vid_textureMisses;
+	if(evictions) *evictions = vid_textureEvictions;
+	if(bytes) *bytes = vid_textureBytes;
+}
+
+// Clears memory for the given texture (shared textures are freed once every user has cleared them)
 void vid_clearTexture(VidTexture* t)
 {
 	if(t > 0) {
@@ -270,18 +603,69 @@ void vid_flush()
 	}
 }
 
+// Flushes only the given rectangles (x, y, w, h each) of the video buffer to the screen
+void vid_flushRects(const int* rects, int count)
+{
+	if(vid_scrMain && count > 0) {
+		SDL_Rect sdlRects[count];
+		for(int i=0; i<count; i++) {
+			sdlRects[i].x = rects[i*4];
+			sdlRects[i].y = rects[i*4 + 1];
+			sdlRects[i].w = rects[i*4 + 2];
+			sdlRects[i].h = rects[i*4 + 3];
+		}
+		SDL_UpdateRects(vid_scrMain, count, sdlRects);
+	}
+}
+
+// Limits drawing to the given rectangle
+void vid_setClip(int x, int y, int w, int h)
+{
+	if(vid_scrMain) {
+		SDL_Rect clip = {(signed short)x, (signed short)y, (unsigned short)w, (unsigned short)h};
+		SDL_SetClipRect(vid_scrMain, &clip);
+	}
+}
+
+// Removes any drawing limit
+void vid_clearClip()
+{
+	if(vid_scrMain) SDL_SetClipRect(vid_scrMain, NULL);
+}
+
 // Clears any cached elements (must reinitialize)
 int vid_clear()
 {
 	//clear resources
+	vid_stopImageWorker();
 	if(vid_shade) SDL_FreeSurface(vid_shade);
 	vid_shade = NULL;
 	if(vid_cachedImage) SDL_FreeSurface(vid_cachedImage);
 	vid_cachedImage = NULL;
 	vid_cachedImageFilename[0] = 0;
-	if(vid_cachedFont) TTF_CloseFont(vid_cachedFont);
-	vid_cachedFont = NULL;
-	vid_cachedFontSize = -1;
+	for(int i=0; i<VID_MAX_ATLASES; i++) {
+		if(vid_atlases[i].surface) SDL_FreeSurface(vid_atlases[i].surface);
+		vid_atlases[i].surface = NULL;
+	}
+	vid_nextAtlas = 0;
+	for(int i=0; i<VID_MAX_FONTS; i++) {
+		if(vid_fonts[i].font) TTF_CloseFont(vid_fonts[i].font);
+		vid_fonts[i].font = NULL;
+	}
+	for(int i=0; i<VID_MAX_OVERLAYS; i++) {
+		if(vid_overlays[i].surface) SDL_FreeSurface(vid_overlays[i].surface);
+		vid_overlays[i].surface = NULL;
+		vid_overlays[i].filename[0] = 0;
+	}
+	vid_nextOverlay = 0;
+	for(int i=0; i<VID_MAX_FRAMES; i++) {
+		if(vid_frames[i].surface) SDL_FreeSurface(vid_frames[i].surface);
+		vid_frames[i].surface = NULL;
+	}
+	vid_nextFrame = 0;
+	for(int i=0; i<VID_MAX_CACHED_TEXTURES; i++) {
+		if(vid_textures[i].surface) vid_evictTexture(&vid_textures[i]);
+	}
 	
 	vid_isInitFlag = INIT_FLAG_PARTIAL;
 	return 0;
@@ -291,6 +675,7 @@ int vid_clear()
 int vid_close()
 {
 	//clear resources
+	vid_stopImageWorker();
 	if(vid_scrMain) SDL_FreeSurface(vid_scrMain);
 	vid_scrMain = NULL;
 	vid_clear();
@@ -303,3 +688,540 @@ int vid_close()
 	vid_isInitFlag = INIT_FLAG_NOT;
 	return 0;
 }
+
+// Scales a surface to the given size in the screen format
+static SDL_Surface* vid_scaleSurface(SDL_Surface* source, int w, int h, char smooth) {
+	if(source->format->BitsPerPixel == 32 || source->format->BitsPerPixel == 8) {
+		return zoomSurface(source, (double)w/(double)(source->w), (double)h/(double)(source->h), smooth);
+	}
+	
+	//make sure to convert back to optimized format
+	SDL_Surface* scaledRaw = zoomSurface(source, (double)w/(double)(source->w), (double)h/(double)(source->h), smooth);
+	SDL_Surface* scaled = SDL_ConvertSurface(scaledRaw, vid_scrMain->format, SURFACE_TYPE);
+	SDL_FreeSurface(scaledRaw);
+	return scaled;
+}
+
+// Gets an overlay image decoded and scaled to the given size, keeping the most recent ones around
+static SDL_Surface* vid_getOverlay(const char* filename, int w, int h, char smooth) {
+	for(int i=0; i<VID_MAX_OVERLAYS; i++) {
+		vid_overlay* overlay = &vid_overlays[i];
+		if(overlay->surface && overlay->w == w && overlay->h == h && overlay->smooth == smooth && strcmp(overlay->filename, filename) == 0) {
+			return overlay->surface;
+		}
+	}
+	if(strlen(filename) >= MAX_IMAGE_CACHE_FILENAME_SIZE) return NULL;
+	
+	SDL_Surface* imgSurfaceRaw = IMG_Load(filename);
+	if(imgSurfaceRaw == NULL) return NULL;
+	SDL_Surface* imgSurfaceZoomed = zoomSurface(imgSurfaceRaw, (double)w/(double)(imgSurfaceRaw->w), (double)h/(double)(imgSurfaceRaw->h), smooth);
+	SDL_FreeSurface(imgSurfaceRaw);
+	SDL_Surface* imgSurfaceOpt = SDL_ConvertSurface(imgSurfaceZoomed, vid_scrMain->format, SURFACE_TYPE);
+	SDL_FreeSurface(imgSurfaceZoomed);
+	
+	//replace the oldest entry
+	vid_overlay* overlay = &vid_overlays[vid_nextOverlay];
+	vid_nextOverlay = (vid_nextOverlay + 1) % VID_MAX_OVERLAYS;
+	if(overlay->surface) SDL_FreeSurface(overlay->surface);
+	strcpy(overlay->filename, filename);
+	overlay->w = w;
+	overlay->h = h;
+	overlay->smooth = smooth;
+	overlay->surface = imgSurfaceOpt;
+	return imgSurfaceOpt;
+}
+
+// Finds a texture in the cache and takes a reference to it (null if not cached)
+static SDL_Surface* vid_findTexture(const char* filename, int w, int h, char smooth) {
+	for(int i=0; i<VID_MAX_CACHED_TEXTURES; i++) {
+		vid_cachedTexture* entry = &vid_textures[i];
+		if(entry->surface && entry->w == w && entry->h == h && entry->smooth == smooth && strcmp(entry->filename, filename) == 0) {
+			entry->lastUsed = ++vid_textureClock;
+			entry->surface->refcount++;
+			vid_textureHits++;
+			return entry->surface;
+		}
+	}
+	vid_textureMisses++;
+	return NULL;
+}
+
+// Adds a texture to the cache (which keeps its own reference) then evicts the least recently used until under budget
+static void vid_cacheTexture(const char* filename, int w, int h, char smooth, SDL_Surface* surface) {
+	if(surface && strlen(filename) < MAX_IMAGE_CACHE_FILENAME_SIZE) {
+		vid_cachedTexture* entry = &vid_textures[0];
+		for(int i=0; i<VID_MAX_CACHED_TEXTURES; i++) {
+			if(vid_textures[i].surface == NULL) {
+				entry = &vid_textures[i];
+				break;
+			}
+			if(vid_textures[i].lastUsed < entry->lastUsed) entry = &vid_textures[i];
+		}
+		if(entry->surface) vid_evictTexture(entry);
+		
+		strcpy(entry->filename, filename);
+		entry->w = w;
+		entry->h = h;
+		entry->smooth = smooth;
+		entry->lastUsed = ++vid_textureClock;
+		entry->bytes = surface->h * surface->pitch;
+		entry->surface = surface;
+		surface->refcount++;
+		vid_textureBytes += entry->bytes;
+	}
+	
+	while(vid_textureBytes > vid_textureBudget) {
+		vid_cachedTexture* oldest = NULL;
+		for(int i=0; i<VID_MAX_CACHED_TEXTURES; i++) {
+			if(vid_textures[i].surface && (oldest == NULL || vid_textures[i].lastUsed < oldest->lastUsed)) oldest = &vid_textures[i];
+		}
+		if(oldest == NULL) break;
+		vid_evictTexture(oldest);
+	}
+}
+
+// Drops the cache's reference to a texture
+static void vid_evictTexture(vid_cachedTexture* entry) {
+	vid_textureBytes -= entry->bytes;
+	vid_textureEvictions++;
+	SDL_FreeSurface(entry->surface);
+	entry->surface = NULL;
+	entry->filename[0] = 0;
+}
+
+// Gets a texture that is safe to draw onto, copying it if anyone else holds a reference
+static SDL_Surface* vid_ownTexture(SDL_Surface* surface) {
+	if(surface->refcount <= 1) return surface;
+	SDL_Surface* copy = SDL_ConvertSurface(surface, surface->format, SURFACE_TYPE);
+	SDL_FreeSurface(surface);
+	return copy;
+}
+
+// Gets the font at the given size, keeping every size in use open
+static TTF_Font* vid_getFont(int size) {
+	for(int i=0; i<VID_MAX_FONTS; i++) {
+		if(vid_fonts[i].font && vid_fonts[i].size == size) return vid_fonts[i].font;
+	}
+	
+	TTF_Font* font = TTF_OpenFont(vid_fontFile, size);
+	if(font == NULL) return NULL;
+	for(int i=0; i<VID_MAX_FONTS; i++) {
+		if(vid_fonts[i].font == NULL) {
+			vid_fonts[i].size = size;
+			vid_fonts[i].font = font;
+			return font;
+		}
+	}
+	
+	//table full, the first slot gets reused
+	TTF_CloseFont(vid_fonts[0].font);
+	vid_fonts[0].size = size;
+	vid_fonts[0].font = font;
+	return font;
+}
+
+// Gets the glyph atlas for the given size, style and colors, rendering it on first use
+static vid_atlas* vid_getAtlas(int size, char bold, SDL_Color foreground, SDL_Color background) {
+	Uint32 fg = (foreground.r << 16) | (foreground.g << 8) | foreground.b;
+	Uint32 bg = (background.r << 16) | (background.g << 8) | background.b;
+	for(int i=0; i<VID_MAX_ATLASES; i++) {
+		vid_atlas* atlas = &vid_atlases[i];
+		if(atlas->surface && atlas->size == size && atlas->bold == bold && atlas->foreground == fg && atlas->background == bg) return atlas;
+	}
+	TTF_Font* font = vid_getFont(size);
+	if(font == NULL) return NULL;
+	TTF_SetFontStyle(font, bold ? TTF_STYLE_BOLD : TTF_STYLE_NORMAL);
+	
+	//render each printable character once, shaded the same way whole strings were (blank ones just advance)
+	SDL_Surface* glyphs[VID_NUM_GLYPHS];
+	short glyphW[VID_NUM_GLYPHS];
+	int width = 0;
+	int height = TTF_FontHeight(font);
+	for(int i=0; i<VID_NUM_GLYPHS; i++) {
+		char str[2] = {(char)(VID_FIRST_GLYPH + i), 0};
+		int advance = 0;
+		glyphs[i] = TTF_RenderText_Shaded(font, str, foreground, background);
+		if(glyphs[i]) {
+			advance = glyphs[i]->w;
+			if(glyphs[i]->h > height) height = glyphs[i]->h;
+		} else if(TTF_GlyphMetrics(font, VID_FIRST_GLYPH + i, NULL, NULL, NULL, NULL, &advance) != 0) {
+			advance = 0;
+		}
+		glyphW[i] = advance;
+		width += advance;
+	}
+	
+	//pack them side by side in the screen format
+	vid_atlas* atlas = &vid_atlases[vid_nextAtlas];
+	vid_nextAtlas = (vid_nextAtlas + 1) % VID_MAX_ATLASES;
+	if(atlas->surface) SDL_FreeSurface(atlas->surface);
+	atlas->surface = SDL_CreateRGBSurface(SURFACE_TYPE, width > 0 ? width : 1, height, vid_scrMain->format->BitsPerPixel, 
+		vid_scrMain->format->Rmask, vid_scrMain->format->Gmask, vid_scrMain->format->Bmask, vid_scrMain->format->Amask);
+	SDL_FillRect(atlas->surface, NULL, SDL_MapRGB(atlas->surface->format, background.r, background.g, background.b));
+	SDL_Rect to = {0, 0, 0, 0};
+	for(int i=0; i<VID_NUM_GLYPHS; i++) {
+		atlas->glyphX[i] = to.x;
+		atlas->glyphW[i] = glyphW[i];
+		if(glyphs[i]) {
+			SDL_Surface* glyph = SDL_ConvertSurface(glyphs[i], vid_scrMain->format, SURFACE_TYPE);
+			SDL_BlitSurface(glyph, NULL, atlas->surface, &to);
+			SDL_FreeSurface(glyph);
+			SDL_FreeSurface(glyphs[i]);
+		}
+		to.x += glyphW[i];
+	}
+	atlas->size = size;
+	atlas->bold = bold;
+	atlas->foreground = fg;
+	atlas->background = bg;
+	return atlas;
+}
+
+// Builds the key of a pre-scaled image and the file it is kept in (returns 0 if the image can't be cached)
+static char vid_thumbKey(vid_thumbHeader* header, char* thumbFilename, const char* filename, int w, int h, char smooth) {
+	struct stat st;
+	if(vid_thumbPath[0] == 0 || strlen(filename) >= MAX_IMAGE_CACHE_FILENAME_SIZE || stat(filename, &st) != 0) return 0;
+	
+	//zeroed first so padding never differs between equal keys
+	memset(header, 0, sizeof(vid_thumbHeader));
+	memcpy(header->magic, vid_thumbMagic, 4);
+	strcpy(header->source, filename);
+	header->w = w;
+	header->h = h;
+	header->smooth = smooth;
+	header->screenFormat[0] = vid_scrMain->format->BitsPerPixel;
+	header->screenFormat[1] = vid_scrMain->format->Rmask;
+	header->screenFormat[2] = vid_scrMain->format->Gmask;
+	header->screenFormat[3] = vid_scrMain->format->Bmask;
+	header->screenFormat[4] = vid_scrMain->format->Amask;
+	
+	//file named by the key hash (FNV-1a), the stored header settles collisions
+	//note: the mtime is left out of the name so a changed source replaces its stale copy instead of adding another
+	unsigned int hash = 2166136261u;
+	unsigned char* data = (unsigned char*)header;
+	for(unsigned int i=0; i<sizeof(vid_thumbHeader); i++) hash = (hash ^ data[i]) * 16777619u;
+	sprintf(thumbFilename, "%s%08x.thb", vid_thumbPath, hash);
+	header->sourceMtime = st.st_mtime;
+	return 1;
+}
+
+// Reads a pre-scaled image if its key matches (null otherwise)
+static SDL_Surface* vid_readThumb(const char* thumbFilename, vid_thumbHeader* header) {
+	FILE* file = fopen(thumbFilename, "rb");
+	if(file == NULL) return NULL;
+	vid_thumbHeader fileHeader;
+	if(fread(&fileHeader, sizeof(vid_thumbHeader), 1, file) != 1 
+		|| memcmp(&fileHeader, header, sizeof(vid_thumbHeader) - sizeof(header->format)) != 0) {
+		fclose(file);
+		return NULL;
+	}
+	
+	//pixels are stored row by row in the surface's own format
+	SDL_Surface* surface = SDL_CreateRGBSurface(SURFACE_TYPE, fileHeader.w, fileHeader.h, fileHeader.format[0], 
+		fileHeader.format[1], fileHeader.format[2], fileHeader.format[3], fileHeader.format[4]);
+	if(surface == NULL) {
+		fclose(file);
+		return NULL;
+	}
+	int rowLength = surface->w * surface->format->BytesPerPixel;
+	char complete = 1;
+	if(SDL_MUSTLOCK(surface)) SDL_LockSurface(surface);
+	for(int y=0; y<surface->h && complete; y++) {
+		if(fread((char*)surface->pixels + y*surface->pitch, rowLength, 1, file) != 1) complete = 0;
+	}
+	if(SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+	fclose(file);
+	
+	if(!complete) {
+		SDL_FreeSurface(surface);
+		return NULL;
+	}
+	return surface;
+}
+
+// Writes a pre-scaled image under the given key
+static void vid_writeThumb(const char* thumbFilename, vid_thumbHeader* header, SDL_Surface* surface) {
+	if(surface == NULL || surface->format->palette != NULL) return;
+	header->format[0] = surface->format->BitsPerPixel;
+	header->format[1] = surface->format->Rmask;
+	header->format[2] = surface->format->Gmask;
+	header->format[3] = surface->format->Bmask;
+	header->format[4] = surface->format->Amask;
+	
+	//write to a temp file (one per thread) then move it into place so readers never see a partial image
+	char tempFilename[MAX_IMAGE_CACHE_FILENAME_SIZE*2 + 24];
+	sprintf(tempFilename, "%s.%lx.tmp", thumbFilename, (unsigned long)pthread_self());
+	FILE* file = fopen(tempFilename, "wb");
+	if(file == NULL) return;
+	char complete = (fwrite(header, sizeof(vid_thumbHeader), 1, file) == 1);
+	int rowLength = surface->w * surface->format->BytesPerPixel;
+	if(SDL_MUSTLOCK(surface)) SDL_LockSurface(surface);
+	for(int y=0; y<surface->h && complete; y++) {
+		if(fwrite((char*)surface->pixels + y*surface->pitch, rowLength, 1, file) != 1) complete = 0;
+	}
+	if(SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+	if(fclose(file) != 0) complete = 0;
+	if(!complete) {
+		remove(tempFilename);
+		return;
+	}
+	
+	//keep a running total of the folder size (less any stale copy this replaces) and trim once over budget
+	pthread_mutex_lock(&vid_thumbMutex);
+	struct stat st;
+	long long replaced = (stat(thumbFilename, &st) == 0) ? st.st_size : 0;
+	if(rename(tempFilename, thumbFilename) == 0) {
+		if(vid_thumbBytes >= 0) vid_thumbBytes += (long long)sizeof(vid_thumbHeader) + (long long)rowLength*surface->h - replaced;
+		vid_trimThumbs();
+	} else {
+		remove(tempFilename);
+	}
+	pthread_mutex_unlock(&vid_thumbMutex);
+}
+
+// Checks for a pre-scaled image with a matching key without reading its pixels
+static char vid_hasThumb(const char* thumbFilename, vid_thumbHeader* header) {
+	FILE* file = fopen(thumbFilename, "rb");
+	if(file == NULL) return 0;
+	vid_thumbHeader fileHeader;
+	char match = (fread(&fileHeader, sizeof(vid_thumbHeader), 1, file) == 1 
+		&& memcmp(&fileHeader, header, sizeof(vid_thumbHeader) - sizeof(header->format)) == 0);
+	fclose(file);
+	return match;
+}
+
+// Deletes the oldest pre-scaled copies until the folder is back under budget, tallying the folder if not yet known (called with the thumb mutex held)
+static void vid_trimThumbs() {
+	if(vid_thumbPath[0] == 0 || (vid_thumbBytes >= 0 && vid_thumbBytes <= vid_thumbBudget)) return;
+	DIR* dir = opendir(vid_thumbPath);
+	if(dir == NULL) return;
+	
+	//list every pre-scaled copy with its size and age
+	vid_thumbFile* files = NULL;
+	int count = 0;
+	int capacity = 0;
+	long long total = 0;
+	char path[MAX_IMAGE_CACHE_FILENAME_SIZE*2];
+	struct dirent* entry;
+	while((entry = readdir(dir)) != NULL) {
+		int length = strlen(entry->d_name);
+		if(length < 4 || length >= (int)sizeof(files[0].name) || strcmp(entry->d_name + length - 4, ".thb") != 0) continue;
+		struct stat st;
+		sprintf(path, "%s%s", vid_thumbPath, entry->d_name);
+		if(stat(path, &st) != 0) continue;
+		total += st.st_size;
+		if(count == capacity) {
+			int grownCapacity = capacity ? capacity*2 : 64;
+			vid_thumbFile* grown = (vid_thumbFile*)realloc(files, grownCapacity*sizeof(vid_thumbFile));
+			if(grown == NULL) continue;
+			files = grown;
+			capacity = grownCapacity;
+		}
+		strcpy(files[count].name, entry->d_name);
+		files[count].mtime = st.st_mtime;
+		files[count].bytes = st.st_size;
+		count++;
+	}
+	closedir(dir);
+	
+	//delete the oldest down to three quarters of the budget so the next few writes don't trim again
+	if(total > vid_thumbBudget && count > 0) {
+		qsort(files, count, sizeof(vid_thumbFile), vid_compareThumbAge);
+		long long target = vid_thumbBudget / 4 * 3;
+		for(int i=0; i<count && total > target; i++) {
+			sprintf(path, "%s%s", vid_thumbPath, files[i].name);
+			if(remove(path) == 0) total -= files[i].bytes;
+		}
+	}
+	free(files);
+	vid_thumbBytes = total;
+}
+
+// Orders pre-scaled copies oldest first
+static int vid_compareThumbAge(const void* a, const void* b) {
+	long long ageA = ((const vid_thumbFile*)a)->mtime;
+	long long ageB = ((const vid_thumbFile*)b)->mtime;
+	return (ageA > ageB) - (ageA < ageB);
+}
+
+// Loads each size not already given from its pre-scaled copy, or else decodes the image and scales it (only the main thread keeps the decoded image around)
+static void vid_loadImageSizes(const char* filename, int count, const int* w, const int* h, char smooth, SDL_Surface** surfaces, char mainThread) {
+	vid_thumbHeader thumbHeaders[VID_MAX_IMAGE_SIZES];
+	char thumbFilenames[VID_MAX_IMAGE_SIZES][MAX_IMAGE_CACHE_FILENAME_SIZE*2];
+	char useThumbs[VID_MAX_IMAGE_SIZES];
+	char missing = 0;
+	for(int i=0; i<count; i++) {
+		useThumbs[i] = 0;
+		if(surfaces[i]) continue;
+		useThumbs[i] = vid_thumbKey(&thumbHeaders[i], thumbFilenames[i], filename, w[i], h[i], smooth);
+		if(useThumbs[i]) surfaces[i] = vid_readThumb(thumbFilenames[i], &thumbHeaders[i]);
+		if(surfaces[i] == NULL) missing = 1;
+	}
+	if(!missing) return;
+	
+	//decode the full image
+	SDL_Surface* image = NULL;
+	if(mainThread && strcmp(filename, vid_cachedImageFilename) == 0) {
+		image = vid_cachedImage;
+	} else {
+		SDL_Surface* imgSurfaceRaw = IMG_Load(filename);
+		if(imgSurfaceRaw) {
+			image = SDL_ConvertSurface(imgSurfaceRaw, vid_scrMain->format, SURFACE_TYPE);
+			SDL_FreeSurface(imgSurfaceRaw);
+		}
+		if(mainThread) {
+			if(vid_cachedImage) SDL_FreeSurface(vid_cachedImage);
+			vid_cachedImage = image;
+			strncpy(vid_cachedImageFilename, filename, MAX_IMAGE_CACHE_FILENAME_SIZE);
+			vid_cachedImageFilename[MAX_IMAGE_CACHE_FILENAME_SIZE-1] = 0;
+		}
+	}
+	if(image == NULL) return;
+	
+	//each size is scaled from the last one that came out rather than the full image
+	SDL_Surface* source = image;
+	for(int i=0; i<count; i++) {
+		if(surfaces[i] == NULL) {
+			surfaces[i] = vid_scaleSurface(source, w[i], h[i], smooth);
+			if(useThumbs[i]) vid_writeThumb(thumbFilenames[i], &thumbHeaders[i], surfaces[i]);
+		}
+		if(surfaces[i]) source = surfaces[i];
+	}
+	if(!mainThread) SDL_FreeSurface(image);
+}
+
+// Adds a request for the worker, or one already done if surfaces are given (returns its id, 0 if the queue is full)
+static int vid_queueImageRequest(const char* filename, int count, const int* w, const int* h, char smooth, char prefetch, SDL_Surface** surfaces) {
+	if(strlen(filename) >= MAX_IMAGE_CACHE_FILENAME_SIZE) return 0;
+	pthread_mutex_lock(&vid_requestMutex);
+	
+	//start the worker on first use
+	if(!vid_workerRunning && surfaces == NULL) {
+		vid_workerRunning = 1;
+		if(pthread_create(&vid_workerThread, NULL, vid_imageWorker, NULL) != 0) {
+			vid_workerRunning = 0;
+			pthread_mutex_unlock(&vid_requestMutex);
+			return 0;
+		}
+	}
+	
+	int id = 0;
+	for(int r=0; r<VID_MAX_IMAGE_REQUESTS; r++) {
+		vid_imageRequest* req = &vid_requests[r];
+		if(req->state != VID_REQUEST_FREE) continue;
+		id = vid_nextRequestId++;
+		if(vid_nextRequestId <= 0) vid_nextRequestId = 1;
+		req->id = id;
+		req->prefetch = prefetch;
+		strcpy(req->filename, filename);
+		req->count = count;
+		req->smooth = smooth;
+		for(int i=0; i<count; i++) {
+			req->w[i] = w[i];
+			req->h[i] = h[i];
+			req->surfaces[i] = surfaces ? surfaces[i] : NULL;
+		}
+		req->state = surfaces ? VID_REQUEST_DONE : VID_REQUEST_QUEUED;
+		pthread_cond_signal(&vid_requestCond);
+		break;
+	}
+	pthread_mutex_unlock(&vid_requestMutex);
+	return id;
+}
+
+// Background thread that works through queued requests oldest first
+static void* vid_imageWorker(void* args) {
+	pthread_mutex_lock(&vid_requestMutex);
+	while(vid_workerRunning) {
+		vid_imageRequest* req = NULL;
+		for(int r=0; r<VID_MAX_IMAGE_REQUESTS; r++) {
+			if(vid_requests[r].state == VID_REQUEST_QUEUED && (req == NULL || vid_requests[r].id < req->id)) req = &vid_requests[r];
+		}
+		if(req == NULL) {
+			pthread_cond_wait(&vid_requestCond, &vid_requestMutex);
+			continue;
+		}
+		
+		//the request stays put while loading since cancelling only flags it
+		req->state = VID_REQUEST_LOADING;
+		pthread_mutex_unlock(&vid_requestMutex);
+		SDL_Surface* surfaces[VID_MAX_IMAGE_SIZES];
+		char done = 0;
+		if(req->prefetch) {
+			done = 1;
+			for(int i=0; i<req->count && done; i++) {
+				vid_thumbHeader header;
+				char thumbFilename[MAX_IMAGE_CACHE_FILENAME_SIZE*2];
+				done = vid_thumbKey(&header, thumbFilename, req->filename, req->w[i], req->h[i], req->smooth) && vid_hasThumb(thumbFilename, &header);
+			}
+		}
+		for(int i=0; i<req->count; i++) surfaces[i] = NULL;
+		if(!done) vid_loadImageSizes(req->filename, req->count, req->w, req->h, req->smooth, surfaces, 0);
+		pthread_mutex_lock(&vid_requestMutex);
+		
+		//prefetched images only needed to reach the disk
+		if(req->prefetch || req->state == VID_REQUEST_CANCELLED) {
+			for(int i=0; i<req->count; i++) {
+				if(surfaces[i]) SDL_FreeSurface(surfaces[i]);
+			}
+			req->state = VID_REQUEST_FREE;
+		} else {
+			for(int i=0; i<req->count; i++) req->surfaces[i] = surfaces[i];
+			req->state = VID_REQUEST_DONE;
+		}
+	}
+	pthread_mutex_unlock(&vid_requestMutex);
+	return 0;
+}
+
+// Stops the worker and drops every request
+static void vid_stopImageWorker() {
+	pthread_mutex_lock(&vid_requestMutex);
+	char running = vid_workerRunning;
+	vid_workerRunning = 0;
+	pthread_cond_broadcast(&vid_requestCond);
+	pthread_mutex_unlock(&vid_requestMutex);
+	if(running) pthread_join(vid_workerThread, NULL);
+	
+	for(int r=0; r<VID_MAX_IMAGE_REQUESTS; r++) {
+		vid_imageRequest* req = &vid_requests[r];
+		if(req->state == VID_REQUEST_DONE) {
+			for(int i=0; i<req->count; i++) {
+				if(req->surfaces[i]) SDL_FreeSurface(req->surfaces[i]);
+				req->surfaces[i] = NULL;
+			}
+		}
+		req->state = VID_REQUEST_FREE;
+	}
+}
+
+// Fills in the lines (x, y, w, h from the box corner) and their colors for a frame style around a box (returns the style's border)
+static int vid_frameLines(char style, int w, int h, unsigned char r, unsigned char g, unsigned char b, int lines[][4], SDL_Color* lineColors) {
+	if(style == VID_FRAME_OUTLINE) {
+		int width = VID_FRAME_OUTLINE_BORDER - 1;
+		int outline[VID_FRAME_MAX_LINES][4] = {
+			{-width, -width, w+(width*2), width}, {-width, h, w+(width*2), width},
+			{-width, -width, width, h+(width*2)}, {w, -width, width, h+(width*2)},
+			{-(width-1), -(width+1), w+((width-1)*2), 1}, {-(width-1), h+width, w+((width-1)*2), 1},
+			{-(width+1), -(width-1), 1, h+((width-1)*2)}, {w+width, -(width-1), 1, h+((width-1)*2)} };
+		memcpy(lines, outline, sizeof(outline));
+		for(int i=0; i<VID_FRAME_MAX_LINES; i++) {
+			lineColors[i].r = r;
+			lineColors[i].g = g;
+			lineColors[i].b = b;
+		}
+		return VID_FRAME_OUTLINE_BORDER;
+	}
+	
+	int shadow[VID_FRAME_MAX_LINES][4] = {
+		{-1, -1, w+2, 1}, {-1, h, w+2, 1}, {-1, -1, 1, h+2}, {w, -1, 1, h+2},
+		{0, -2, w, 1}, {0, h+1, w, 1}, {-2, 0, 1, h}, {w+1, 0, 1, h} };
+	memcpy(lines, shadow, sizeof(shadow));
+	for(int i=0; i<VID_FRAME_MAX_LINES; i++) {
+		unsigned char falloff = (i < 4) ? 30 : 40;
+		lineColors[i].r = falloff;
+		lineColors[i].g = falloff;
+		lineColors[i].b = falloff;
+	}
+	return VID_FRAME_SHADOW_BORDER;
+}
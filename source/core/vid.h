@@ -1,6 +1,12 @@
 #ifndef VID_H
 #define VID_H
 
+#define VID_FRAME_SHADOW 0
+#define VID_FRAME_OUTLINE 1
+
+#define VID_FRAME_SHADOW_BORDER 2
+#define VID_FRAME_OUTLINE_BORDER 5
+
 typedef void VidTexture;
 
 // Setup and initialize the Video interface
@@ -33,6 +39,27 @@ void vid_drawTexture(VidTexture* t, int x, int y);
 // Generates a texture from the given image file
 VidTexture* vid_generateImageTexture(const char* filename, int w, int h, char smooth);
 
+// Generates textures of several sizes from one image file, decoding it once and scaling each size from the one before (largest first)
+void vid_generateImageTextures(const char* filename, int count, const int* w, const int* h, char smooth, VidTexture** textures);
+
+// Sets the folder to keep pre-scaled copies of image textures in (null disables)
+void vid_setImageCache(const char* dirPath);
+
+// Sets the most disk space the pre-scaled copies take up in bytes (the oldest are deleted first)
+void vid_setImageCacheBudget(unsigned int bytes);
+
+// Queues textures of several sizes from one image file to be decoded and scaled in the background (returns a request id, 0 if not queued)
+int vid_requestImageTextures(const char* filename, int count, const int* w, const int* h, char smooth);
+
+// Collects the textures of a background request (returns 1 once collected, 0 while still loading, -1 for an unknown request)
+int vid_collectImageTextures(int request, VidTexture** textures);
+
+// Queues an image file to be scaled into the pre-scaled copies on disk in the background without keeping it in memory (returns a request id, 0 if not queued)
+int vid_prefetchImageTextures(const char* filename, int count, const int* w, const int* h, char smooth);
+
+// Cancels a background request, dropping anything it loaded
+void vid_cancelImageTextures(int request);
+
 // Generates a texture from the given text
 VidTexture* vid_generateTextTexture(const char* text, unsigned char rF, unsigned char gF, unsigned char bF, 
 		unsigned char rB, unsigned char gB, unsigned char bB, char fontSize, char isBold);
@@ -40,18 +67,39 @@ VidTexture* vid_generateTextTexture(const char* text, unsigned char rF, unsigned
 // Generates a texture from the current state of the screen
 VidTexture* vid_generateScreenTexture(int x, int y, int w, int h);
 
-// Compsites the given image onto the given texture
-void vid_compositeImageToTexture(VidTexture* t, const char* filename, unsigned char opaque, char smooth);
+// Compsites the given image onto the given texture (returns the texture to use, a private copy if it was shared)
+VidTexture* vid_compositeImageToTexture(VidTexture* t, const char* filename, unsigned char opaque, char smooth);
+
+// Compsites the given color onto the given texture (returns the texture to use, a private copy if it was shared)
+VidTexture* vid_compositeColorToTexture(VidTexture* t, unsigned char r, unsigned char g, unsigned char b, unsigned char opaque);
+
+// Draws the drop shadow or outline (in the given color) around a box straight to the screen (for boxes still changing size)
+void vid_drawFrame(char style, int x, int y, int w, int h, unsigned char r, unsigned char g, unsigned char b);
+
+// Generates the drop shadow or outline (in the given color) around a box of the given size as one texture, shared between boxes alike (draw it up and left by the style's border)
+VidTexture* vid_generateFrameTexture(char style, int w, int h, unsigned char r, unsigned char g, unsigned char b);
 
-// Compsites the given color onto the given texture
-void vid_compositeColorToTexture(VidTexture* t, unsigned char r, unsigned char g, unsigned char b, unsigned char opaque);
+// Sets the most memory the texture cache holds on to in bytes (textures still in use are kept until released)
+void vid_setTextureCacheBudget(unsigned int bytes);
 
-// Clears memory for the given texture
+// Gets the texture cache counters (any can be null)
+void vid_getTextureCacheStats(unsigned int* hits, unsigned int* misses, unsigned int* evictions, unsigned int* bytes);
+
+// Clears memory for the given texture (shared textures are freed once every user has cleared them)
 void vid_clearTexture(VidTexture* t);
 
 // Flushes the video buffer to the screen
 void vid_flush();
 
+// Flushes only the given rectangles (x, y, w, h each) of the video buffer to the screen
+void vid_flushRects(const int* rects, int count);
+
+// Limits drawing to the given rectangle
+void vid_setClip(int x, int y, int w, int h);
+
+// Removes any drawing limit
+void vid_clearClip();
+
 // Clears any cached elements (must reinitialize)
 int vid_clear();
 
@@ -30,6 +30,7 @@
 
 //functions
 void core_close();
+void showCartridgePage(CMenuManager* menuManager, CGameManager* gameManager);
 
 //program entry
 int main(int argc, char** argv)
@@ -44,12 +45,16 @@ int main(int argc, char** argv)
 		return 1;
 	}
 	wgc_startPolling();
+	gbx_startMonitor();
+	vid_setImageCache("data/thumbs/");
 	
 	//create the managers
 	CSettingsManager* settingsManager = new CSettingsManager();
 	CSceneManager* sceneManager = new CSceneManager();
 	CMenuManager* menuManager = new CMenuManager(sceneManager, settingsManager);
 	CGameManager* gameManager = new CGameManager(settingsManager);	
+	vid_setTextureCacheBudget(settingsManager->getPropertyInteger("video.texture.cache.kb", 16384) * 1024);
+	vid_setImageCacheBudget(settingsManager->getPropertyInteger("video.thumb.cache.kb", 131072) * 1024);
 	
 	//start on the Cartridge Page if cartridge, otherwise Catalog Page
 	menuManager->setPageCartridgeEmpty(true);
@@ -93,6 +98,20 @@ int main(int argc, char** argv)
 		selectionState = menuManager->getPageSelection();
 		
 		
+		// Cartridge Inserted/Removed?
+		bool cartEvent = false;
+		while(gbx_pollEvent() != GBX_EVENT_NONE) cartEvent = true;
+		if(cartEvent) {
+			gameManager->loadCartridge();
+			if(menuManager->getPage() == MENU_PAGE_STATE_CARTRIDGE) showCartridgePage(menuManager, gameManager);
+			selectionState = menuManager->getPageSelection();
+		}
+		
+		
+		// Background dump of an uncatalogued cartridge
+		gameManager->updateStaging();
+		
+		
 		// Exit?
 		if(inp_getButtonState(INP_BTN_RT) > 0 && inp_getButtonState(INP_BTN_LF) > 0 
 			&& inp_getButtonState(INP_BTN_UP) > 0 && inp_getButtonState(INP_BTN_DN) > 0 && inp_getButtonState(INP_BTN_A) == 1) break;
@@ -102,30 +121,14 @@ int main(int argc, char** argv)
 		if(inp_getButtonState(INP_BTN_A) == 1 && selectionState == MENU_SELECTION_STATE_CARTRIDGE) {
 			menuManager->setPageCartridgeEmpty(true);
 			gameManager->loadCartridge();
-			if(gameManager->getCartridgeType() == CARTRIDGE_TYPE_NONE) {
-				menuManager->setPageCartridgeEmpty(false);
-				menuManager->setPageSelection(MENU_SELECTION_STATE_REFRESH, true);
-			} else {
-				menuManager->setPageCartridge(gameManager->getCartridgeName(), gameManager->getCartridgeImgBoxart(), gameManager->getCartridgeImgTitle(), 
-					gameManager->getCartridgeImgSnap(), gameManager->getCartridgeType()==CARTRIDGE_TYPE_GBA, gameManager->getCartridgeCatalogIndex() >= 0);
-				if(gameManager->getCartridgeCatalogIndex() >= 0) menuManager->setPageSelection(MENU_SELECTION_STATE_PLAY, true);
-				else menuManager->setPageSelection(MENU_SELECTION_STATE_SYNC, true);
-			}
+			showCartridgePage(menuManager, gameManager);
 		}
 		
 		// Cartridge Refresh?
 		if(inp_getButtonState(INP_BTN_A) == 1 && selectionState == MENU_SELECTION_STATE_REFRESH) {
 			menuManager->setPageCartridgeEmpty(true);
 			gameManager->loadCartridge();
-			if(gameManager->getCartridgeType() == CARTRIDGE_TYPE_NONE) {
-				menuManager->setPageCartridgeEmpty(false);
-				menuManager->setPageSelection(MENU_SELECTION_STATE_REFRESH, true);
-			} else {
-				menuManager->setPageCartridge(gameManager->getCartridgeName(), gameManager->getCartridgeImgBoxart(), gameManager->getCartridgeImgTitle(), 
-					gameManager->getCartridgeImgSnap(), gameManager->getCartridgeType()==CARTRIDGE_TYPE_GBA, gameManager->getCartridgeCatalogIndex() >= 0);
-				if(gameManager->getCartridgeCatalogIndex() >= 0) menuManager->setPageSelection(MENU_SELECTION_STATE_PLAY, true);
-				else menuManager->setPageSelection(MENU_SELECTION_STATE_SYNC, true);
-			}
+			showCartridgePage(menuManager, gameManager);
 		}
 		
 		// Cartridge Sync?
@@ -158,6 +161,10 @@ int main(int argc, char** argv)
 				menuManager->showModal("Failed to Sync Cartridge:", "unknown error", 0, 0, 0);
 				doSync = false;
 				
+			} else if(syncCheck == SYNC_CHECK_ERROR_ROM_MISMATCH) {
+				menuManager->showModal("Failed to Sync Cartridge:", "cartridge doesn't match catalogued game", 0, 0, 0);
+				doSync = false;
+				
 			} else if(syncCheck == SYNC_CHECK_ERROR_NO_CARTRIDGE) {
 				menuManager->showModal("Failed to Sync Cartridge:", "cartridge not connected", 0, 0, 0);
 				menuManager->setPageCartridgeEmpty(false);
@@ -176,8 +183,13 @@ int main(int argc, char** argv)
 			//perform sync
 			if(doSync) {
 				int estimateMillis = gameManager->syncCartridgeEstimateTime(updateCartSave);
-				menuManager->showProgressBar("Syncing", estimateMillis);
-				gameManager->syncCartridge(updateCartSave);
+				float syncProgress = 0.0f;
+				bool syncCancel = false;
+				char syncText[64];
+				if(gameManager->getSyncVerifyConfidence() >= 0.0f) sprintf(syncText, "Syncing (ROM verified, %d%% confidence)", (int)(gameManager->getSyncVerifyConfidence() * 100.0f));
+				else sprintf(syncText, "Syncing");
+				menuManager->showProgressBar(syncText, estimateMillis, &syncProgress, &syncCancel);
+				gameManager->syncCartridge(updateCartSave, &syncProgress, &syncCancel);
 				menuManager->endProgressBar();
 				
 				menuManager->setPageCartridge(gameManager->getCartridgeName(), gameManager->getCartridgeImgBoxart(), gameManager->getCartridgeImgTitle(), 
@@ -347,6 +359,20 @@ int main(int argc, char** argv)
 	return 0;
 }
 
+void showCartridgePage(CMenuManager* menuManager, CGameManager* gameManager)
+{
+	//shows the loaded cartridge, or the empty page with refresh selected
+	if(gameManager->getCartridgeType() == CARTRIDGE_TYPE_NONE) {
+		menuManager->setPageCartridgeEmpty(false);
+		menuManager->setPageSelection(MENU_SELECTION_STATE_REFRESH, true);
+	} else {
+		menuManager->setPageCartridge(gameManager->getCartridgeName(), gameManager->getCartridgeImgBoxart(), gameManager->getCartridgeImgTitle(), 
+			gameManager->getCartridgeImgSnap(), gameManager->getCartridgeType()==CARTRIDGE_TYPE_GBA, gameManager->getCartridgeCatalogIndex() >= 0);
+		if(gameManager->getCartridgeCatalogIndex() >= 0) menuManager->setPageSelection(MENU_SELECTION_STATE_PLAY, true);
+		else menuManager->setPageSelection(MENU_SELECTION_STATE_SYNC, true);
+	}
+}
+
 void core_close()
 {
 	gbx_close();